@@ -0,0 +1,228 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#include "graph_ir.h"
+#include "chrono"
+#include "iostream"
+#include "iomanip"
+
+using namespace md::api;
+typedef std::chrono::high_resolution_clock timer;
+
+/**
+ * Compares the NodeArena storage with (graph, id) Node handles against the previous layout,
+ * where the graph kept a std::vector<std::shared_ptr<NodeData>> and every Node was a
+ * std::weak_ptr<NodeData> which had to be locked on each access.
+ * The traversal masks are compared against the previous std::vector<bool> masks.
+ *
+ * Usage: bench_nodes [number_of_nodes] [repeats]
+ */
+namespace {
+    /** Replica of the previous Node, which locked a std::weak_ptr on every field access */
+    class LegacyNode {
+    public:
+        std::weak_ptr<md::gir::NodeData> ptr;
+
+        LegacyNode(std::shared_ptr<md::gir::NodeData> const ptr): ptr(ptr) {};
+
+        std::shared_ptr<md::gir::NodeData> operator->() const {
+            if (ptr.expired()) {
+                throw std::runtime_error("Trying to access the NodeData of a Node, but pointer has expired");
+            }
+            return ptr.lock();
+        }
+    };
+
+    double elapsed_ms(timer::time_point const start, timer::time_point const end){
+        return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+    }
+
+    void report(std::string const name, double const legacy, double const arena){
+        std::cout << std::left << std::setw(24) << name
+                  << std::right << std::setw(14) << legacy
+                  << std::setw(14) << arena
+                  << std::setw(10) << std::setprecision(3) << legacy / arena << "x" << std::endl;
+    }
+
+    bool same_mask(std::vector<bool> const & legacy, md::NodeSet const & arena){
+        if(legacy.size() != arena.size()){
+            return false;
+        }
+        for(size_t i = 0; i < legacy.size(); ++i){
+            if(legacy[i] != arena[i]){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** Builds a chain of n elementwise operations with a fan-out to a second input at each step */
+    Graph build_chain(size_t const n){
+        auto g = create_graph();
+        g->name = "bench_nodes";
+        auto x = g->matrix(md::f32, 10, 10, "x");
+        auto y = g->matrix(md::f32, 10, 10, "y");
+        auto h = x;
+        while(g->nodes.size() < n){
+            h = tanh(h * y + x);
+        }
+        return g;
+    }
+}
+
+int main(int argc, char** argv){
+    size_t const n = argc > 1 ? std::stoul(argv[1]) : 100000;
+    int const repeats = argc > 2 ? std::stoi(argv[2]) : 10;
+
+    auto start = timer::now();
+    auto g = build_chain(n);
+    auto end = timer::now();
+    std::cout << "Graph construction of " << g->nodes.size() << " nodes: "
+              << elapsed_ms(start, end) << "ms" << std::endl << std::endl;
+    std::cout << std::left << std::setw(24) << "benchmark"
+              << std::right << std::setw(14) << "legacy (ms)"
+              << std::setw(14) << "arena (ms)"
+              << std::setw(11) << "speedup" << std::endl;
+
+    // Storage construction
+    double legacy_time = 0, arena_time = 0;
+    std::vector<std::shared_ptr<md::NodeData>> legacy;
+    for(auto r = 0; r < repeats; ++r){
+        legacy.clear();
+        start = timer::now();
+        for(size_t i = 0; i < g->nodes.size(); ++i){
+            auto node = g->nodes[i];
+            legacy.push_back(std::make_shared<md::NodeData>(g.get(), i, node->name, node->device,
+                                                            node->op, node->grad_level, node->scope));
+        }
+        end = timer::now();
+        legacy_time += elapsed_ms(start, end);
+
+        md::NodeArena arena(g.get());
+        start = timer::now();
+        for(size_t i = 0; i < g->nodes.size(); ++i){
+            auto node = g->nodes[i];
+            arena.emplace(node->name, node->device, node->op, node->grad_level, node->scope);
+        }
+        end = timer::now();
+        arena_time += elapsed_ms(start, end);
+    }
+    report("storage construction", legacy_time / repeats, arena_time / repeats);
+
+    // Replicate the handles of the previous layout
+    std::vector<LegacyNode> legacy_handles;
+    std::vector<std::vector<LegacyNode>> legacy_children(legacy.size());
+    for(size_t i = 0; i < legacy.size(); ++i){
+        legacy_handles.push_back(LegacyNode(legacy[i]));
+        for(auto child: g->edges.children(i)){
+            legacy_children[i].push_back(LegacyNode(legacy[child]));
+        }
+    }
+
+    // Field access through the handles
+    size_t legacy_sum = 0, arena_sum = 0;
+    legacy_time = 0, arena_time = 0;
+    for(auto r = 0; r < repeats; ++r){
+        start = timer::now();
+        for(size_t i = 0; i < legacy_handles.size(); ++i){
+            legacy_sum += legacy_handles[i]->grad_level + legacy_handles[i]->id;
+        }
+        end = timer::now();
+        legacy_time += elapsed_ms(start, end);
+
+        start = timer::now();
+        for(size_t i = 0; i < g->nodes.size(); ++i){
+            auto node = g->nodes[i];
+            arena_sum += node->grad_level + node->id;
+        }
+        end = timer::now();
+        arena_time += elapsed_ms(start, end);
+    }
+    report("field access", legacy_time / repeats, arena_time / repeats);
+
+    // Descendants traversal, following the children of each node
+    legacy_time = 0, arena_time = 0;
+    for(auto r = 0; r < repeats; ++r){
+        std::vector<bool> legacy_mask(legacy.size(), false);
+        legacy_mask[0] = true;
+        start = timer::now();
+        for(size_t i = 0; i < legacy.size(); ++i){
+            if(legacy_mask[i]){
+                auto children = legacy_children[i];
+                for(size_t j = 0; j < children.size(); ++j){
+                    legacy_mask[children[j]->id] = true;
+                }
+            }
+        }
+        end = timer::now();
+        legacy_time += elapsed_ms(start, end);
+
+        start = timer::now();
+        auto arena_mask = g->get_descendants_mask(md::NodeVec{g->nodes[0]});
+        end = timer::now();
+        arena_time += elapsed_ms(start, end);
+        if(not same_mask(legacy_mask, arena_mask)){
+            std::cerr << "The descendants masks do not match" << std::endl;
+            return 1;
+        }
+    }
+    report("descendants traversal", legacy_time / repeats, arena_time / repeats);
+
+    // Flow trees of many (roots, leafs) pairs, one at a time with boolean vectors against the batched sweep
+    size_t const queries = 64;
+    std::vector<md::NodeVec> roots, leafs;
+    for(size_t q = 0; q < queries; ++q){
+        roots.push_back(md::NodeVec{g->nodes[q % 2]});
+        leafs.push_back(md::NodeVec{g->nodes[g->nodes.size() - 1 - q * (g->nodes.size() / (2 * queries))]});
+    }
+    legacy_time = 0, arena_time = 0;
+    for(auto r = 0; r < repeats; ++r){
+        std::vector<std::vector<bool>> legacy_trees;
+        start = timer::now();
+        for(size_t q = 0; q < queries; ++q){
+            std::vector<bool> descendants(legacy.size(), false), ancestors(legacy.size(), false);
+            descendants[roots[q][0].id] = true;
+            for(size_t i = 0; i < legacy.size(); ++i){
+                if(descendants[i]){
+                    auto children = legacy_children[i];
+                    for(size_t j = 0; j < children.size(); ++j){
+                        descendants[children[j]->id] = true;
+                    }
+                }
+            }
+            ancestors[leafs[q][0].id] = true;
+            for(size_t i = legacy.size() - 1; i < legacy.size(); --i){
+                if(ancestors[i]){
+                    auto parents = g->nodes[i]->op->get_ancestors();
+                    for(size_t j = 0; j < parents.size(); ++j){
+                        ancestors[parents[j].id] = true;
+                    }
+                }
+            }
+            for(size_t i = 0; i < legacy.size(); ++i){
+                descendants[i] = descendants[i] and ancestors[i];
+            }
+            legacy_trees.push_back(descendants);
+        }
+        end = timer::now();
+        legacy_time += elapsed_ms(start, end);
+
+        start = timer::now();
+        auto arena_trees = g->get_flow_tree_masks(roots, leafs);
+        end = timer::now();
+        arena_time += elapsed_ms(start, end);
+        for(size_t q = 0; q < queries; ++q){
+            if(not same_mask(legacy_trees[q], arena_trees[q])){
+                std::cerr << "The flow tree masks do not match" << std::endl;
+                return 1;
+            }
+        }
+    }
+    report("64 flow trees", legacy_time / repeats, arena_time / repeats);
+    if(legacy_sum != arena_sum){
+        std::cerr << "The field access checksums do not match" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,514 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#include "graph_ir.h"
+#include "algorithm"
+#include "chrono"
+#include "fstream"
+#include "functional"
+#include "iostream"
+#include "iomanip"
+#include "map"
+#include "sstream"
+
+using namespace md::api;
+typedef std::chrono::high_resolution_clock timer;
+
+/**
+ * Benchmark suite for the construction and the transformations of graphs.
+ * Each model is built at the requested scale (approximate number of nodes) and the following are timed:
+ * derived_node (graph construction), gradient, gradient_checkpointed, gradient_cached (a repeated request), forward_diff,
+ * hvp and hvp_unshared (Hessian-vector products for 4 directions, with and without the shared work),
+ * gradients_sequential and gradients_concurrent (of 4 objectives, one after the other and on a thread each),
+ * backward_diff_local and forward_diff_local (a derivative whose flow tree is a tiny part of the graph),
+ * jacobian and jacobian_other_mode (of the terms of the loss, in the selected mode and in the other one),
+ * clone, snapshot_rollback, copy_into, copy_masks_into, GraphFunction (as a view and as a copy),
+ * unique_dimensions and the JSON and Cytoscape exports.
+ * The results are written as JSON. When a baseline produced by an earlier run is given,
+ * every benchmark whose median time grew by more than the tolerance is flagged as a regression
+ * and the program exits with 1.
+ *
+ * Usage: graph_ir_bench [--scale nodes] [--repeats n] [--models mnist,mlp,fanout,fanout_concurrent]
+ *                       [--output file] [--compare baseline] [--tolerance fraction]
+ */
+namespace {
+    /** Differences below this many milliseconds are considered noise and never flagged */
+    double const noise_ms = 0.05;
+
+    /** A built model - the loss and the inputs and parameters it depends on */
+    struct Model {
+        md::Graph graph;
+        md::NodeVec inputs;
+        md::NodeVec params;
+        md::Node loss;
+    };
+
+    typedef std::function<Model(size_t)> ModelBuilder;
+
+    struct Result {
+        std::string model;
+        std::string benchmark;
+        size_t nodes;
+        double min_ms;
+        double median_ms;
+        double baseline_ms;
+    };
+
+    /** Directions for the products of the model, the k-th one being the parameters rotated by 2k (which keeps
+     * the alternating weights and biases of the layers aligned) */
+    std::vector<md::NodeVec> rotated_directions(md::NodeVec const & params, size_t const directions){
+        std::vector<md::NodeVec> result(directions);
+        for(size_t k = 0; k < directions; ++k){
+            for(size_t i = 0; i < params.size(); ++i){
+                result[k].push_back(params[(i + 2 * k) % params.size()]);
+            }
+        }
+        return result;
+    }
+
+    /** Independent objectives of a multi-task model, sharing the whole forward pass - the loss and
+     * three other reductions of its terms */
+    md::NodeVec task_objectives(Model const & model){
+        md::Node const terms = model.loss->op->get_parents()[0];
+        return {model.loss, sum(tanh(terms)), sum(square(terms)), sum(terms * terms * terms)};
+    }
+
+    double elapsed_ms(timer::time_point const start, timer::time_point const end){
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / 1e6;
+    }
+
+    /** The MNIST autoencoder of build_model() in test.cpp, without the gradients. It does not scale. */
+    Model mnist_model(size_t){
+        Model model;
+        model.graph = create_graph();
+        model.graph->name = "MNIST";
+        auto batch_size = new_sym();
+        int const N = 8;
+        int d[N + 1] = {784, 1000, 500, 250, 30, 250, 500, 1000, 784};
+        model.graph->set_scope("Inputs");
+        md::Node input = model.graph->matrix(md::f32, {d[0], batch_size}, "input");
+        model.inputs.push_back(input);
+        md::Node h = input;
+        for(int i = 1; i <= N; ++i){
+            model.graph->set_scope("Layer" + std::to_string(i));
+            auto W = model.graph->parameter("W", md::f32, {d[i], d[i - 1], 1, 1});
+            auto b = model.graph->parameter("b", md::f32, {d[i], 1, 1, 1});
+            model.params.push_back(W);
+            model.params.push_back(b);
+            h = i < N ? tanh(dot(W, h) + b) : dot(W, h) + b;
+        }
+        model.graph->set_scope("Objective");
+        model.loss = sum(square(h - input));
+        return model;
+    }
+
+    /** A deep MLP chain of tanh layers of width 64, with as many layers as fit in the number of nodes */
+    Model mlp_model(size_t const nodes){
+        Model model;
+        model.graph = create_graph();
+        model.graph->name = "MLP";
+        auto batch_size = new_sym();
+        size_t const layers = std::max<size_t>(nodes / 6, 1);
+        md::Node input = model.graph->matrix(md::f32, {64, batch_size}, "input");
+        md::Node target = model.graph->matrix(md::f32, {64, batch_size}, "target");
+        model.inputs = {input, target};
+        md::Node h = input;
+        for(size_t i = 0; i < layers; ++i){
+            model.graph->set_scope("Layer" + std::to_string(i));
+            auto W = model.graph->parameter("W", md::f32, {64, 64, 1, 1});
+            auto b = model.graph->parameter("b", md::f32, {64, 1, 1, 1});
+            model.params.push_back(W);
+            model.params.push_back(b);
+            h = tanh(dot(W, h) + b);
+        }
+        model.graph->set_scope("Objective");
+        model.loss = sum(square(h - target));
+        return model;
+    }
+
+    /** A wide graph, where a single input fans out to independent branches which are summed together */
+    Model fanout_model(size_t const nodes){
+        Model model;
+        model.graph = create_graph();
+        model.graph->name = "FanOut";
+        auto batch_size = new_sym();
+        size_t const width = std::max<size_t>(nodes / 5, 1);
+        md::Node input = model.graph->matrix(md::f32, {64, batch_size}, "input");
+        model.inputs = {input};
+        md::Node loss;
+        for(size_t i = 0; i < width; ++i){
+            auto p = model.graph->parameter("p" + std::to_string(i), md::f32, {64, batch_size, 1, 1});
+            model.params.push_back(p);
+            auto branch = sum(tanh(input * p));
+            loss = i == 0 ? branch : loss + branch;
+        }
+        model.loss = loss;
+        return model;
+    }
+
+    /** The same graph as fanout_model(), but the branches are built concurrently in chunks (see build_concurrently()) */
+    Model fanout_concurrent_model(size_t const nodes){
+        Model model;
+        model.graph = create_graph();
+        model.graph->name = "FanOutConcurrent";
+        auto batch_size = new_sym();
+        size_t const width = std::max<size_t>(nodes / 5, 1);
+        size_t const chunks = std::min<size_t>(std::max<unsigned>(std::thread::hardware_concurrency(), 1) * 4, width);
+        md::Node input = model.graph->matrix(md::f32, {64, batch_size}, "input");
+        model.inputs = {input};
+        auto parts = md::gir::build_concurrently(model.graph, chunks, [&](md::GraphBuilder & builder, size_t chunk) {
+            auto x = builder.import(input);
+            md::NodeVec result = {md::Node()};
+            for(size_t i = chunk * width / chunks; i < (chunk + 1) * width / chunks; ++i){
+                auto p = builder.graph->parameter("p" + std::to_string(i), md::f32, {64, batch_size, 1, 1});
+                result.push_back(p);
+                auto branch = sum(tanh(x * p));
+                result[0] = result[0].empty() ? branch : result[0] + branch;
+            }
+            return result;
+        });
+        md::Node loss;
+        for(auto const & part: parts){
+            model.params.insert(model.params.end(), part.begin() + 1, part.end());
+            loss = loss.empty() ? part[0] : loss + part[0];
+        }
+        model.loss = loss;
+        return model;
+    }
+
+    /** Runs the function repeats times and records the minimum and median of the timings */
+    Result measure(std::string const model, std::string const benchmark, int const repeats,
+                   std::function<void()> const setup, std::function<size_t()> const run){
+        std::vector<double> timings;
+        size_t nodes = 0;
+        for(auto r = 0; r < repeats; ++r){
+            setup();
+            auto start = timer::now();
+            nodes = run();
+            auto end = timer::now();
+            timings.push_back(elapsed_ms(start, end));
+        }
+        std::sort(timings.begin(), timings.end());
+        return Result{model, benchmark, nodes, timings[0], timings[timings.size() / 2], -1};
+    }
+
+    std::vector<Result> run_model(std::string const name, ModelBuilder const builder,
+                                  size_t const scale, int const repeats){
+        std::vector<Result> results;
+        Model model;
+        auto fresh = [&]() { model = builder(scale); };
+        auto nothing = []() {};
+        results.push_back(measure(name, "derived_node", repeats, nothing, [&]() {
+            model = builder(scale);
+            return model.graph->nodes.size();
+        }));
+        results.push_back(measure(name, "gradient", repeats, fresh, [&]() {
+            gradient(model.loss, model.params);
+            return model.graph->nodes.size();
+        }));
+        results.push_back(measure(name, "gradient_checkpointed", repeats, fresh, [&]() {
+            gradient(model.loss, model.params, size_t(0));
+            return model.graph->nodes.size();
+        }));
+        results.push_back(measure(name, "gradient_cached", repeats, [&]() {
+            model = builder(scale);
+            gradient(model.loss, model.params, size_t(0));
+        }, [&]() {
+            // The same checkpointed gradient again, which otherwise recomputes the forward nodes anew
+            gradient(model.loss, model.params, size_t(0));
+            return model.graph->nodes.size();
+        }));
+        results.push_back(measure(name, "forward_diff", repeats, fresh, [&]() {
+            model.graph->forward_diff(md::NodeVec{model.loss}, model.params, model.params);
+            return model.graph->nodes.size();
+        }));
+        results.push_back(measure(name, "hvp", repeats, fresh, [&]() {
+            model.graph->hvp(model.loss, model.params, rotated_directions(model.params, 4));
+            return model.graph->nodes.size();
+        }));
+        results.push_back(measure(name, "hvp_unshared", repeats, fresh, [&]() {
+            // What hvp() replaces - a gradient and a forward_diff() of it by hand for each direction
+            for(auto const & direction: rotated_directions(model.params, 4)){
+                auto const model_grads = gradient(model.loss, model.params);
+                model.graph->forward_diff(model_grads, direction, model.params);
+            }
+            return model.graph->nodes.size();
+        }));
+
+        results.push_back(measure(name, "gradients_sequential", repeats, fresh, [&]() {
+            for(auto const & objective: task_objectives(model)){
+                gradient(objective, model.params);
+            }
+            return model.graph->nodes.size();
+        }));
+        results.push_back(measure(name, "gradients_concurrent", repeats, fresh, [&]() {
+            gradients(task_objectives(model), model.params);
+            return model.graph->nodes.size();
+        }));
+
+        // The remaining benchmarks run on the full training graph with the gradients
+        model = builder(scale);
+        auto grads = gradient(model.loss, model.params);
+        md::Graph const g = model.graph;
+        // A derivative deep inside the graph, whose flow tree is a tiny fraction of the nodes
+        md::Node const local_w = model.params[model.params.size() / 2];
+        md::Node local_f = local_w;
+        for(auto i = 0; i < 3 and g->edges.children(local_f.id).size() > 0; ++i){
+            local_f = g->nodes[g->edges.children(local_f.id)[0]];
+        }
+        local_f = sum(local_f);
+        // The repeats must not be served by the derivative cache
+        auto uncached = [&]() { g->derivative_cache.clear(); };
+        results.push_back(measure(name, "backward_diff_local", repeats, uncached, [&]() {
+            gradient(local_f, md::NodeVec{local_w});
+            return g->get_flow_tree(md::NodeVec{local_w}, md::NodeVec{local_f}).size();
+        }));
+        results.push_back(measure(name, "forward_diff_local", repeats, nothing, [&]() {
+            g->forward_diff(md::NodeVec{local_f}, md::NodeVec{local_w}, md::NodeVec{local_w});
+            return g->get_flow_tree(md::NodeVec{local_w}, md::NodeVec{local_f}).size();
+        }));
+        // The Jacobian of the terms of the loss with respect to the first parameter,
+        // in the automatically selected mode and in the other one
+        md::Node const terms = model.loss->op->get_parents()[0];
+        md::NodeVec const first_w = {model.params[0]};
+        DiffMode const other_mode = g->jacobian_mode(terms, first_w) == FORWARD_MODE ?
+                                        REVERSE_MODE : FORWARD_MODE;
+        results.push_back(measure(name, "jacobian", repeats, nothing, [&]() {
+            g->jacobian(terms, first_w);
+            return g->nodes.size();
+        }));
+        results.push_back(measure(name, "jacobian_other_mode", repeats, nothing, [&]() {
+            g->jacobian(terms, first_w, other_mode);
+            return g->nodes.size();
+        }));
+        results.push_back(measure(name, "clone", repeats, nothing, [&]() {
+            return g->clone()->nodes.size();
+        }));
+        results.push_back(measure(name, "snapshot_rollback", repeats, nothing, [&]() {
+            // A small experimental rewrite on top of the full graph, which is then undone
+            auto snapshot = g->snapshot();
+            for(auto i = 0; i < grads.size(); ++i){
+                tanh(grads[i]);
+            }
+            g->rollback(snapshot);
+            g->release(snapshot);
+            return g->nodes.size();
+        }));
+        results.push_back(measure(name, "copy_into", repeats, nothing, [&]() {
+            auto copy = create_graph();
+            g->copy_into(copy, g->get_ancestors_mask(grads), md::Updates{}, true, true);
+            return copy->nodes.size();
+        }));
+        results.push_back(measure(name, "copy_masks_into", repeats, nothing, [&]() {
+            // The ancestors of the gradients split into two disjoint halves by id
+            auto const all = g->get_ancestors_mask(grads);
+            md::NodeSet first = all, second = all;
+            for(auto i: all){
+                (i < g->nodes.size() / 2 ? second : first).erase(i);
+            }
+            auto copy = create_graph();
+            g->copy_masks_into(copy, {first, second}, md::Updates{}, true, true);
+            return copy->nodes.size();
+        }));
+        results.push_back(measure(name, "graph_function", repeats, nothing, [&]() {
+            return md::GraphFunction(g, model.inputs, grads).size();
+        }));
+        results.push_back(measure(name, "graph_function_copy", repeats, nothing, [&]() {
+            return md::GraphFunction(g, model.inputs, grads, md::Updates{}, true, false).size();
+        }));
+        results.push_back(measure(name, "unique_dimensions", repeats, nothing, [&]() {
+            md::gir::unique_dimensions(g);
+            return g->nodes.size();
+        }));
+        results.push_back(measure(name, "json_export", repeats, nothing, [&]() {
+            std::ostringstream s;
+            md::json::export_graph(g, s);
+            return g->nodes.size();
+        }));
+        results.push_back(measure(name, "cytoscape_export", repeats, nothing, [&]() {
+            std::ostringstream s;
+            md::cytoscape::export_graph(g, s);
+            return g->nodes.size();
+        }));
+        return results;
+    }
+
+    /** Fills the baseline_ms of each result from a previous output, returns false if it can not be read */
+    bool load_baseline(std::string const path, size_t const scale, std::vector<Result> & results){
+        std::ifstream f(path);
+        if(not f){
+            return false;
+        }
+        std::stringstream buffer;
+        buffer << f.rdbuf();
+        rapidjson::Document doc;
+        doc.Parse(buffer.str().c_str());
+        if(doc.HasParseError() or not doc.IsObject() or not doc.HasMember("results") or not doc["results"].IsArray()){
+            return false;
+        }
+        if(doc.HasMember("scale") and doc["scale"].GetUint64() != scale){
+            std::cerr << "Warning: the baseline was run with scale " << doc["scale"].GetUint64()
+                      << ", but the current scale is " << scale << std::endl;
+        }
+        auto const & baseline = doc["results"];
+        for(size_t i = 0; i < baseline.Size(); ++i){
+            std::string const model = baseline[i]["model"].GetString();
+            std::string const benchmark = baseline[i]["benchmark"].GetString();
+            for(auto & result: results){
+                if(result.model == model and result.benchmark == benchmark){
+                    result.baseline_ms = baseline[i]["median_ms"].GetDouble();
+                }
+            }
+        }
+        return true;
+    }
+
+    bool is_regression(Result const & result, double const tolerance){
+        return result.baseline_ms >= 0 and
+               result.median_ms > result.baseline_ms * (1 + tolerance) and
+               result.median_ms - result.baseline_ms > noise_ms;
+    }
+
+    std::string to_json(std::vector<Result> const & results, size_t const scale, int const repeats,
+                        bool const compare, double const tolerance){
+        rapidjson::StringBuffer sb;
+        rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(sb);
+        writer.StartObject();
+        writer.String("scale");
+        writer.Uint64(scale);
+        writer.String("repeats");
+        writer.Int(repeats);
+        writer.String("results");
+        writer.StartArray();
+        for(auto const & result: results){
+            writer.StartObject();
+            writer.String("model");
+            writer.String(result.model);
+            writer.String("benchmark");
+            writer.String(result.benchmark);
+            writer.String("nodes");
+            writer.Uint64(result.nodes);
+            writer.String("min_ms");
+            writer.Double(result.min_ms);
+            writer.String("median_ms");
+            writer.Double(result.median_ms);
+            writer.String("nodes_per_second");
+            writer.Double(result.min_ms > 0 ? result.nodes / result.min_ms * 1000 : 0);
+            if(compare and result.baseline_ms >= 0){
+                writer.String("baseline_ms");
+                writer.Double(result.baseline_ms);
+                writer.String("ratio");
+                writer.Double(result.baseline_ms > 0 ? result.median_ms / result.baseline_ms : 1);
+                writer.String("regression");
+                writer.Bool(is_regression(result, tolerance));
+            }
+            writer.EndObject();
+        }
+        writer.EndArray();
+        writer.EndObject();
+        return sb.GetString();
+    }
+
+    std::vector<std::string> split(std::string const & value){
+        std::vector<std::string> parts;
+        std::stringstream s(value);
+        std::string part;
+        while(std::getline(s, part, ',')){
+            parts.push_back(part);
+        }
+        return parts;
+    }
+}
+
+int main(int argc, char** argv){
+    size_t scale = 10000;
+    int repeats = 5;
+    double tolerance = 0.1;
+    std::string output, baseline;
+    std::vector<std::string> models = {"mnist", "mlp", "fanout", "fanout_concurrent"};
+    for(auto i = 1; i < argc; ++i){
+        std::string const arg = argv[i];
+        if(i + 1 == argc){
+            std::cerr << "Missing value for " << arg << std::endl;
+            return 2;
+        }
+        std::string const value = argv[++i];
+        if(arg == "--scale"){
+            scale = std::stoul(value);
+        } else if(arg == "--repeats"){
+            repeats = std::max(std::stoi(value), 1);
+        } else if(arg == "--models"){
+            models = split(value);
+        } else if(arg == "--output"){
+            output = value;
+        } else if(arg == "--compare"){
+            baseline = value;
+        } else if(arg == "--tolerance"){
+            tolerance = std::stod(value);
+        } else {
+            std::cerr << "Unknown argument " << arg << std::endl;
+            return 2;
+        }
+    }
+
+    std::map<std::string, ModelBuilder> const builders = {
+            {"mnist", mnist_model},
+            {"mlp", mlp_model},
+            {"fanout", fanout_model},
+            {"fanout_concurrent", fanout_concurrent_model}
+    };
+    std::vector<Result> results;
+    for(auto const & name: models){
+        auto builder = builders.find(name);
+        if(builder == builders.end()){
+            std::cerr << "Unknown model " << name << std::endl;
+            return 2;
+        }
+        auto model_results = run_model(name, builder->second, scale, repeats);
+        results.insert(results.end(), model_results.begin(), model_results.end());
+    }
+
+    bool const compare = not baseline.empty();
+    if(compare and not load_baseline(baseline, scale, results)){
+        std::cerr << "Could not read the baseline " << baseline << std::endl;
+        return 2;
+    }
+    auto const json = to_json(results, scale, repeats, compare, tolerance);
+    if(output.empty()){
+        std::cout << json << std::endl;
+    } else {
+        std::ofstream f(output);
+        f << json << std::endl;
+    }
+
+    // Human readable summary
+    size_t regressions = 0;
+    std::cerr << std::left << std::setw(18) << "model" << std::setw(20) << "benchmark"
+              << std::right << std::setw(10) << "nodes" << std::setw(14) << "median (ms)";
+    if(compare){
+        std::cerr << std::setw(14) << "baseline (ms)" << std::setw(10) << "ratio";
+    }
+    std::cerr << std::endl;
+    for(auto const & result: results){
+        std::cerr << std::left << std::setw(18) << result.model << std::setw(20) << result.benchmark
+                  << std::right << std::setw(10) << result.nodes << std::setw(14) << result.median_ms;
+        if(compare and result.baseline_ms >= 0){
+            std::cerr << std::setw(14) << result.baseline_ms
+                      << std::setw(10) << std::setprecision(3)
+                      << (result.baseline_ms > 0 ? result.median_ms / result.baseline_ms : 1)
+                      << std::setprecision(6);
+            if(is_regression(result, tolerance)){
+                std::cerr << "  REGRESSION";
+                ++regressions;
+            }
+        }
+        std::cerr << std::endl;
+    }
+    if(regressions > 0){
+        std::cerr << regressions << " benchmark(s) regressed by more than "
+                  << tolerance * 100 << "% against " << baseline << std::endl;
+        return 1;
+    }
+    return 0;
+}
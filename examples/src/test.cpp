@@ -4,6 +4,7 @@
 
 #include "mock.h"
 #include "complex"
+#include "cmath"
 
 /**
 #define debug(fmt, ...)\
@@ -76,8 +77,119 @@ md::GraphFunction simple_model(SymInt a){
     return GraphFunction("simple", g, NodeVec{input}, NodeVec{s1});
 }
 
+/** Differentiates a call of a subroutine whose body calls another subroutine */
+bool check_nested_subroutine_gradient(){
+    auto n = new_sym("m");
+    auto inner_graph = create_graph();
+    auto x = inner_graph->vector(md::f32, n, "x");
+    auto inner = make_subroutine("inner", inner_graph, NodeVec{x}, NodeVec{tanh(x) * x});
+    auto outer_graph = create_graph();
+    auto y = outer_graph->vector(md::f32, n, "y");
+    auto outer = make_subroutine("outer", outer_graph, NodeVec{y}, NodeVec{call(inner, NodeVec{y})[0] + y});
+    auto g = create_graph();
+    auto p = g->vector(md::f32, n, "p");
+    auto grads = gradient(sum(call(outer, NodeVec{p})[0]), NodeVec{p});
+    if(grads.size() != 1 or grads[0]->shape != p->shape){
+        return false;
+    }
+    // d/dp (tanh(p) * p + p) = tanh(p) + p * (1 - tanh(p)^2) + 1
+    auto backend = std::make_shared<mock::MockBackend>(false);
+    auto func = backend->make_source_gen_function(GraphFunction("nested", g, NodeVec{p}, grads));
+    func->initialize({{n, 5}});
+    auto in = mock::make_var(f32, std::array<long, 4> {5, 1, 1, 1});
+    for(auto i = 0; i < 5; ++i){
+        in->get<float>()[i] = 0.3f * i - 0.6f;
+    }
+    mock::VarVec ins = {in}, outputs;
+    std::tie(outputs, std::ignore) = func->eval(ins);
+    for(auto i = 0; i < 5; ++i){
+        float const v = in->get<float>()[i], t = std::tanh(v);
+        if(std::abs(outputs[0]->get<float>()[i] - (t + v * (1 - t * t) + 1)) > 1e-4){
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Copies a gradient with rematerialization, whose recomputed nodes must be kept apart from their originals */
+bool check_checkpointed_copies(){
+    auto g = create_graph();
+    auto x = g->matrix(md::f32, 8, 8, "x");
+    auto W = g->parameter("W", md::f32, {8, 8, 1, 1});
+    Node h = x;
+    for(auto i = 0; i < 4; ++i){
+        h = tanh(dot(W, h));
+    }
+    auto grads = gradient(sum(h), NodeVec{W}, size_t(1));
+    if(g->clone()->nodes.size() != g->nodes.size()){
+        return false;
+    }
+    // The extra updates of a training function require a copy of its nodes, which must all be kept
+    Node step = W - grads[0];
+    GraphFunction view("view", g, NodeVec{x}, NodeVec{grads[0], step});
+    Updates updates;
+    updates[W] = step;
+    GraphFunction train("train", g, NodeVec{x}, grads, updates);
+    return not train.is_view() and train.size() == view.size() and
+           train.node_ids.back() < train.graph->nodes.size();
+}
+
+/** Compares jvp() and hvp() of sum((x * y) * (x + y)) with their closed forms */
+bool check_jvp_hvp(){
+    auto g = create_graph();
+    auto x = g->vector(md::f32, 4, "x");
+    auto y = g->vector(md::f32, 4, "y");
+    auto vx = g->vector(md::f32, 4, "vx");
+    auto vy = g->vector(md::f32, 4, "vy");
+    auto f = sum((x * y) * (x + y));
+    auto jvps = g->jvp(NodeVec{f}, NodeVec{x, y}, std::vector<NodeVec>{NodeVec{vx, vy}});
+    auto hvps = g->hvp(f, NodeVec{x, y}, std::vector<NodeVec>{NodeVec{vx, vy}});
+    if(jvps.size() != 1 or jvps[0].size() != 1 or hvps.size() != 1 or hvps[0].size() != 2){
+        return false;
+    }
+    auto backend = std::make_shared<mock::MockBackend>(false);
+    auto func = backend->make_source_gen_function(GraphFunction("products", g, NodeVec{x, y, vx, vy},
+                                                                NodeVec{jvps[0][0], hvps[0][0], hvps[0][1]}));
+    func->initialize();
+    mock::VarVec ins, outputs;
+    for(auto k = 0; k < 4; ++k){
+        ins.push_back(mock::make_var(f32, std::array<long, 4> {4, 1, 1, 1}));
+        for(auto i = 0; i < 4; ++i){
+            ins[k]->get<float>()[i] = 0.5f * (i + 1) * (k % 2 == 0 ? 1 : -1) + 0.25f * k;
+        }
+    }
+    std::tie(outputs, std::ignore) = func->eval(ins);
+    auto close = [](float const value, float const expected){
+        return std::abs(value - expected) <= 1e-4 * (1 + std::abs(expected));
+    };
+    // The gradient is (2xy + y^2, x^2 + 2xy) and the Hessian [[2y, 2x + 2y], [2x + 2y, 2x]]
+    float jvp = 0;
+    for(auto i = 0; i < 4; ++i){
+        float const xi = ins[0]->get<float>()[i], yi = ins[1]->get<float>()[i];
+        float const vxi = ins[2]->get<float>()[i], vyi = ins[3]->get<float>()[i];
+        jvp += (2 * xi * yi + yi * yi) * vxi + (xi * xi + 2 * xi * yi) * vyi;
+        if(not close(outputs[1]->get<float>()[i], 2 * yi * vxi + (2 * xi + 2 * yi) * vyi) or
+           not close(outputs[2]->get<float>()[i], (2 * xi + 2 * yi) * vxi + 2 * xi * vyi)){
+            return false;
+        }
+    }
+    return close(outputs[0]->get<float>()[0], jvp);
+}
+
 int main(){
     md::gir::console_logging(true);
+    if(not check_checkpointed_copies()){
+        std::cerr << "The copies of a gradient with rematerialization are wrong" << std::endl;
+        return 1;
+    }
+    if(not check_nested_subroutine_gradient()){
+        std::cerr << "The gradient through nested subroutines is wrong" << std::endl;
+        return 1;
+    }
+    if(not check_jvp_hvp()){
+        std::cerr << "The Jacobian-vector or Hessian-vector products are wrong" << std::endl;
+        return 1;
+    }
     auto n = new_sym("n");
 //    auto gf = build_model();
     auto gf = simple_model(n);
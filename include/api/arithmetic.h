@@ -148,13 +148,13 @@ namespace md{
 
         // Compound Add
         inline Node& operator+=(Node & node1, Node const & node2){
-            node1.ptr = api::add(node1, node2).ptr;
+            node1 = api::add(node1, node2);
             return node1;
         }
 
         template<typename T, typename = std::enable_if<!std::is_same<T, Node>::value>>
         inline Node operator+=(Node & node1, T const & node2) {
-            node1.ptr = api::add(node1, wrap(node2, node1.g())).ptr;
+            node1 = api::add(node1, wrap(node2, node1.g()));
             return node1;
         };
 
@@ -179,13 +179,13 @@ namespace md{
 
         // Compound Neg
         inline Node& operator-=(Node & node1, Node const & node2){
-            node1.ptr = api::neg(node1, node2).ptr;
+            node1 = api::neg(node1, node2);
             return node1;
         }
 
         template<typename T, typename = std::enable_if<!std::is_same<T, Node>::value>>
         inline Node operator-=(Node & node1, T const & node2) {
-            node1.ptr = api::neg(node1, wrap(node2, node1.g())).ptr;
+            node1 = api::neg(node1, wrap(node2, node1.g()));
             return node1;
         };
 
@@ -206,13 +206,13 @@ namespace md{
 
         // Compound Mul
         inline Node& operator*=(Node & node1, Node const & node2){
-            node1.ptr = api::mul(node1, node2).ptr;
+            node1 = api::mul(node1, node2);
             return node1;
         }
 
         template<typename T, typename = std::enable_if<!std::is_same<T, Node>::value>>
         inline Node operator*=(Node & node1, T const & node2) {
-            node1.ptr = api::mul(node1, wrap(node2, node1.g())).ptr;
+            node1 = api::mul(node1, wrap(node2, node1.g()));
             return node1;
         };
 
@@ -233,13 +233,13 @@ namespace md{
 
         // Compound Div
         inline Node& operator/=(Node & node1, Node const & node2){
-            node1.ptr = api::div(node1, node2).ptr;
+            node1 = api::div(node1, node2);
             return node1;
         }
 
         template<typename T, typename = std::enable_if<!std::is_same<T, Node>::value>>
         inline Node operator/=(Node & node1, T const & node2) {
-            node1.ptr = api::div(node1, wrap(node2, node1.g())).ptr;
+            node1 = api::div(node1, wrap(node2, node1.g()));
             return node1;
         };
 
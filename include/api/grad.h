@@ -14,6 +14,47 @@ namespace md{
          * @return
          */
         NodeVec gradient(Node const f, NodeVec const & w);
+
+        /** @brief Calculates the gradient of f with respect to the variables w, keeping only the checkpoints
+         * of the forward pass and recomputing the rest of it during the backward pass
+         * (see GraphInternal::backward_diff())
+         *
+         * @param f
+         * @param w
+         * @param checkpoints
+         * @return
+         */
+        NodeVec gradient(Node const f, NodeVec const & w, NodeSet const & checkpoints);
+
+        /** @brief Calculates the gradient of f with respect to the variables w, keeping at most
+         * max_checkpoints nodes of the forward pass (see GraphInternal::select_checkpoints())
+         * and recomputing the rest of it during the backward pass
+         *
+         * @param f
+         * @param w
+         * @param max_checkpoints
+         * @return
+         */
+        NodeVec gradient(Node const f, NodeVec const & w, size_t const max_checkpoints);
+
+        /** @brief Calculates the gradients of each of the independent objectives f with respect to the variables w,
+         * building them concurrently (see GraphInternal::backward_diff_concurrently())
+         *
+         * @param f
+         * @param w
+         * @param threads - the number of threads, 0 means std::thread::hardware_concurrency()
+         * @return - for every f the gradients for every w
+         */
+        std::vector<NodeVec> gradients(NodeVec const & f, NodeVec const & w, size_t const threads = 0);
+
+        /** @brief Calculates the Jacobian of f with respect to each of the variables w, in whichever of forward
+         * and reverse mode is cheaper (see GraphInternal::jacobian())
+         *
+         * @param f
+         * @param w
+         * @return
+         */
+        NodeVec jacobian(Node const f, NodeVec const & w);
     }
 }
 
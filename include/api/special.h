@@ -46,6 +46,15 @@ namespace md{
          */
         void update(Node shared, Node update);
 
+        /** @brief Calls the subroutine with the arguments, without inlining its body.
+         * The arguments must have the same shapes and data types as the inputs of the body.
+         *
+         * @param body
+         * @param args
+         * @return A Node for each of the outputs of the body
+         */
+        NodeVec call(SubRoutinePtr body, NodeVec args);
+
         /** @brief Makes a selection elementwise between two tensors based on the condition
          *
          * Formally R = select(C, A, B), then
@@ -0,0 +1,113 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#ifndef METADIFF_GRAPH_IR_ARENA_H
+#define METADIFF_GRAPH_IR_ARENA_H
+
+namespace md{
+    namespace gir{
+        /**
+         * A monotonic arena, which hands out memory from large blocks and releases all of it at once
+         * when it is destroyed. Small allocations which are freed before that are kept in pools
+         * by their size and reused by later allocations of the same size, so that operators which are
+         * created and discarded (e.g. when an equivalent node already exists) do not grow the arena.
+         * Like the rest of a GraphInternal it is not thread safe.
+         */
+        class MonotonicArena {
+        public:
+            /** The size of a single block */
+            static size_t const block_size = size_t(1) << 16;
+            /** The granularity (and alignment) of all allocations */
+            static size_t const granularity = 16;
+            /** Freed allocations up to this size are pooled */
+            static size_t const max_pooled = 512;
+
+            MonotonicArena();
+
+            MonotonicArena(MonotonicArena const & arena) = delete;
+
+            MonotonicArena& operator=(MonotonicArena const & arena) = delete;
+
+            ~MonotonicArena();
+
+            /** @brief Returns memory for the given number of bytes, aligned to granularity
+             *
+             * @param bytes
+             * @return
+             */
+            void * allocate(size_t const bytes);
+
+            /** @brief Returns memory obtained from allocate() with the same number of bytes.
+             * Small allocations are pooled for reuse, larger ones are released only with the arena.
+             *
+             * @param ptr
+             * @param bytes
+             */
+            void deallocate(void * const ptr, size_t const bytes);
+
+            /** @brief Returns the number of bytes reserved from the system
+             *
+             * @return
+             */
+            size_t reserved() const {
+                return reserved_bytes;
+            }
+
+        private:
+            /** All of the blocks, including those of large allocations */
+            std::vector<char*> blocks;
+            /** The free range of the current block */
+            char * current;
+            char * end;
+            size_t reserved_bytes;
+            /** Singly linked lists of freed allocations, one for each multiple of granularity */
+            std::array<void*, max_pooled / granularity> pools;
+
+            static size_t round_up(size_t const bytes) {
+                return (bytes + granularity - 1) & ~(granularity - 1);
+            }
+        };
+
+        /** A standard allocator which allocates from a MonotonicArena */
+        template <typename T>
+        class ArenaAllocator {
+        public:
+            typedef T value_type;
+
+            MonotonicArena * arena;
+
+            ArenaAllocator(MonotonicArena * const arena):
+                    arena(arena) {};
+
+            template <typename U>
+            ArenaAllocator(ArenaAllocator<U> const & other):
+                    arena(other.arena) {};
+
+            T * allocate(size_t const n) {
+                static_assert(alignof(T) <= MonotonicArena::granularity, "Over aligned types are not supported.");
+                return static_cast<T*>(arena->allocate(n * sizeof(T)));
+            }
+
+            void deallocate(T * const ptr, size_t const n) {
+                arena->deallocate(ptr, n * sizeof(T));
+            }
+
+            template <typename U>
+            struct rebind {
+                typedef ArenaAllocator<U> other;
+            };
+        };
+
+        template <typename T, typename U>
+        inline bool operator==(ArenaAllocator<T> const & a, ArenaAllocator<U> const & b){
+            return a.arena == b.arena;
+        }
+
+        template <typename T, typename U>
+        inline bool operator!=(ArenaAllocator<T> const & a, ArenaAllocator<U> const & b){
+            return a.arena != b.arena;
+        }
+    }
+}
+#endif //METADIFF_GRAPH_IR_ARENA_H
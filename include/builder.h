@@ -0,0 +1,86 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#ifndef METADIFF_GRAPH_IR_BUILDER_H
+#define METADIFF_GRAPH_IR_BUILDER_H
+
+namespace md{
+    namespace gir{
+        /**
+         * Builds a part of a larger target Graph, so that it can run on a separate thread.
+         * All nodes are created in the builder's own GraphInternal, which has its own scope, node storage and maps,
+         * so nothing is shared with the target or with other builders while building.
+         * Nodes of the target are used through import(), which creates a placeholder input in the builder.
+         * When merged the nodes are copied into the target and the placeholders are substituted by the imported nodes.
+         */
+        class GraphBuilder {
+        public:
+            /** The private graph into which the nodes are built */
+            Graph const graph;
+            /** The graph into which the builder is merged */
+            Graph const target;
+
+            GraphBuilder(Graph const target, std::string const name);
+
+            /** @brief Returns a placeholder in the builder's graph for a node of the target.
+             * Constants are copied as they are instead of a placeholder.
+             * Importing the same node more than once returns the same placeholder.
+             *
+             * @param node
+             * @return
+             */
+            Node import(Node const node);
+
+            /** @brief Copies the masked nodes of the target into the builder, importing their parents which are not
+             * masked, so that they can be transformed (e.g. differentiated) there. When merged the copies are not
+             * copied back, but substituted by the nodes they were copied from, just like the placeholders.
+             * Afterwards import() of a masked node returns its copy.
+             *
+             * @param mask
+             * @return The mapping from the nodes of the target to their copies and placeholders
+             */
+            IdRemap import_copies(NodeSet const & mask);
+
+            /** @brief Copies all of the nodes of the builder into the target, substituting the placeholders
+             * with the imported nodes. Must not run concurrently with anything else modifying the target.
+             *
+             * @return The mapping from the builder's nodes to the nodes of the target
+             */
+            Updates merge_into() const;
+
+            /** @brief Copies only the ancestors of the outputs into the target, the same way as merge_into(),
+             * such that the other nodes of the builder, for instance temporary placeholders, are left out.
+             * The updates of the builder are not merged.
+             *
+             * @param outputs
+             * @return The mapping from the copied nodes of the builder to the nodes of the target
+             */
+            Updates merge_into(NodeVec const & outputs) const;
+
+        private:
+            /** Mapping each placeholder and copy to the imported node of the target */
+            Updates imported;
+            /** Mapping the id of an imported node of the target to its placeholder or copy */
+            std::unordered_map<size_t, Node> placeholders;
+        };
+
+        typedef std::function<NodeVec(GraphBuilder &, size_t)> BuildFunction;
+
+        /** @brief Builds parts of a graph concurrently.
+         * For every index in [0, n) build is called with a separate GraphBuilder and the index
+         * on one of the threads. Afterwards the builders are merged into the graph one by one in the order of the index,
+         * so the ids of the resulting nodes do not depend on the scheduling of the threads.
+         * If any build throws, nothing is merged and the exception of the smallest index is rethrown.
+         *
+         * @param graph
+         * @param n
+         * @param build
+         * @param threads - the number of threads, 0 means std::thread::hardware_concurrency()
+         * @return For each index the nodes returned by build, mapped into the graph
+         */
+        std::vector<NodeVec> build_concurrently(Graph const graph, size_t const n,
+                                                BuildFunction const build, size_t threads = 0);
+    }
+}
+#endif //METADIFF_GRAPH_IR_BUILDER_H
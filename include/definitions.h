@@ -11,7 +11,7 @@ namespace md{
         /** LogLevel */
         typedef spdlog::level::level_enum LogLevel;
         /** Logger Sink */
-        typedef std::shared_ptr<spdlog::sinks::dist_sink_st> LogSink;
+        typedef std::shared_ptr<spdlog::sinks::dist_sink_mt> LogSink;
         /** Forward declaration */
         class GraphInternal;
         /** Just a pointer to GraphInternal */
@@ -32,6 +32,8 @@ namespace md{
         class Node;
         /** Forward declaration */
         class NodeData;
+        /** Forward declaration */
+        class NodeArena;
         /** Operator is just a shared_ptr to AbstractOperator */
         typedef std::shared_ptr<op::AbstractOperator> Operator;
         /** Vector of Nodes */
@@ -40,6 +42,10 @@ namespace md{
         typedef std::pair<Node, Node> Update;
         /** A collection of updates */
         typedef std::unordered_map<Node, Node> Updates;
+        /** Forward declaration */
+        class SubRoutineBody;
+        /** A shared_ptr to the body of a subroutine, which is shared by all of its call sites */
+        typedef std::shared_ptr<SubRoutineBody> SubRoutinePtr;
         /** A shared_ptr to GraphInternal */
         typedef std::shared_ptr<gir::GraphInternal> Graph;
 
@@ -127,13 +133,15 @@ namespace md{
                     inplace_parent_id(-1),
                     buffer_id(-1),
                     buffer_offset(-1),
-                    buffer_size(-1) {};
+                    buffer_size(-1),
+                    lifespan(0) {};
 
             ExecutionData(ExecutionData const & data) :
                     inplace_parent_id(data.inplace_parent_id),
                     buffer_id(data.buffer_id),
                     buffer_offset(data.buffer_offset),
-                    buffer_size(data.buffer_size) {};
+                    buffer_size(data.buffer_size),
+                    lifespan(data.lifespan) {};
         };
 
 //        /**
@@ -0,0 +1,104 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#ifndef METADIFF_GRAPH_IR_EDGES_H
+#define METADIFF_GRAPH_IR_EDGES_H
+
+namespace md{
+    namespace gir{
+        /** A contiguous range of node ids inside an EdgeIndex */
+        class IdRange {
+        public:
+            size_t const * first;
+            size_t const * last;
+
+            IdRange(size_t const * first, size_t const * last):
+                    first(first), last(last) {};
+
+            size_t const * begin() const {
+                return first;
+            }
+
+            size_t const * end() const {
+                return last;
+            }
+
+            size_t size() const {
+                return last - first;
+            }
+
+            size_t operator[](size_t const index) const {
+                return first[index];
+            }
+        };
+
+        /**
+         * An index of all edges of a graph, in both the ancestors and the children directions.
+         * The ancestors are in compressed sparse row (CSR) form - those of each node are appended when the node is
+         * created, as they never change afterwards.
+         * The children are not, since every new node adds a child to nodes anywhere before it, which a CSR could only
+         * absorb by being rebuilt. Instead each node keeps its children in a list of its own, extended when the child
+         * is appended, so the index stays up to date at a constant cost per edge. Thus they are always in increasing order.
+         */
+        class EdgeIndex {
+        public:
+            EdgeIndex():
+                    ancestors_offsets{0} {};
+
+            /** @brief Returns the number of nodes in the index
+             *
+             * @return
+             */
+            size_t size() const {
+                return ancestors_offsets.size() - 1;
+            }
+
+            /** @brief Appends the next node, with the provided ancestors, in the order of AbstractOperator::get_ancestors(),
+             * and adds it to the children of each of them
+             *
+             * @param ancestors
+             */
+            void append(NodeView const ancestors);
+
+            /** @brief Removes all nodes from the index
+             *
+             */
+            void clear();
+
+            /** @brief Removes all nodes with id not smaller than n
+             *
+             * @param n
+             */
+            void truncate(size_t const n);
+
+            /** @brief Returns the ids of the ancestors of the node
+             *
+             * @param id
+             * @return
+             */
+            IdRange ancestors(size_t const id) const {
+                return IdRange(ancestors_ids.data() + ancestors_offsets[id],
+                               ancestors_ids.data() + ancestors_offsets[id + 1]);
+            }
+
+            /** @brief Returns the ids of the children of the node, in increasing order
+             *
+             * @param id
+             * @return
+             */
+            IdRange children(size_t const id) const {
+                return IdRange(children_ids[id].data(), children_ids[id].data() + children_ids[id].size());
+            }
+
+        private:
+            /** The offsets of each node's ancestors in ancestors_ids */
+            std::vector<size_t> ancestors_offsets;
+            /** The ids of the ancestors of all nodes */
+            std::vector<size_t> ancestors_ids;
+            /** The ids of the children of each node, a list per node so that appending a node is never a rebuild */
+            std::vector<std::vector<size_t>> children_ids;
+        };
+    }
+}
+#endif //METADIFF_GRAPH_IR_EDGES_H
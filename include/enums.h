@@ -126,6 +126,16 @@ namespace md{
                     RAISE = 2
         };
 
+        /** The mode of differentiation used for a Jacobian */
+        enum DiffMode {
+            /** Selected from the number of elements of the function and of the parameters */
+                    AUTOMATIC_MODE = 0,
+            /** Forward mode, a tangent for every element of the parameters */
+                    FORWARD_MODE = 1,
+            /** Reverse mode, a cotangent for every element of the function */
+                    REVERSE_MODE = 2
+        };
+
         /** Positivity contraints */
         enum Positivity {
             /** Elements are not constrained */
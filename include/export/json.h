@@ -37,7 +37,7 @@ namespace md{
         void export_execution_data(ExecutionData execution, PrettyWriter<StringBuffer>& writer);
 
         /** Exports a vector of NodeData objects to a wrtier from RapidJson */
-        void export_nodes(std::vector<std::shared_ptr<NodeData>> const &  nodes,
+        void export_nodes(NodeArena const & nodes,
                          PrettyWriter<StringBuffer>& writer);
 
         /** Exports an Operator object to a wrtier from RapidJson */
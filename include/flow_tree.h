@@ -0,0 +1,86 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#ifndef METADIFF_GRAPH_IR_FLOW_TREE_H
+#define METADIFF_GRAPH_IR_FLOW_TREE_H
+
+namespace md{
+    namespace gir{
+        /**
+         * The nodes of a flow tree (see GraphInternal::get_flow_tree()) as a compact worklist in topological
+         * order - the order of their ids. The differentiation passes walk only this list and keep their per node
+         * state indexed by the position of the node in it, so their cost does not depend on the size of the graph.
+         */
+        class FlowTree {
+        public:
+            /** The position of the ids which are not part of the tree */
+            static size_t const missing = std::numeric_limits<size_t>::max();
+
+            /** @brief Returns the number of nodes in the tree
+             *
+             * @return
+             */
+            size_t size() const {
+                return ids.size();
+            }
+
+            /** @brief Returns the id of the node at the position
+             *
+             * @param position
+             * @return
+             */
+            size_t operator[](size_t const position) const {
+                return ids[position];
+            }
+
+            /** @brief Returns the position of the node in the tree, or missing
+             *
+             * @param id
+             * @return
+             */
+            size_t position(size_t const id) const {
+                if(ids.empty() or id < ids.front()){
+                    return missing;
+                }
+                // Dense runs of ids, which are the common case, are found without a search
+                size_t const guess = id - ids.front();
+                if(guess < ids.size() and ids[guess] == id){
+                    return guess;
+                }
+                auto const it = std::lower_bound(ids.begin(), ids.end(), id);
+                return it != ids.end() and *it == id ? static_cast<size_t>(it - ids.begin()) : missing;
+            }
+
+            /** @brief Returns whether the node is part of the tree
+             *
+             * @param id
+             * @return
+             */
+            bool contains(size_t const id) const {
+                return position(id) != missing;
+            }
+
+            /** @brief Appends the node to the tree, its id must be larger than all of the ids in it
+             *
+             * @param id
+             */
+            void push_back(size_t const id) {
+                ids.push_back(id);
+            }
+
+            std::vector<size_t>::const_iterator begin() const {
+                return ids.begin();
+            }
+
+            std::vector<size_t>::const_iterator end() const {
+                return ids.end();
+            }
+
+        private:
+            /** The ids of the nodes, in increasing order */
+            std::vector<size_t> ids;
+        };
+    }
+}
+#endif //METADIFF_GRAPH_IR_FLOW_TREE_H
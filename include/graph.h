@@ -11,20 +11,32 @@ namespace md{
     namespace gir{
         /** A small wrapper class wrapping a Graph, but also having a specified inputs and their ordering,
          * as well as outputs and their ordering.
+         * By default the function is a view - it refers to the original graph and holds only the set of nodes
+         * which are part of it, instead of copying them. Such a view remains valid as long as the original graph
+         * is only extended (e.g. not compacted). The function copies its nodes into a graph of its own only when
+         * it has to - when it is given extra updates or when materialize() is called.
          */
         class GraphFunction{
         public:
             std::string const name;
+            /** The graph of the function, when it is a view this is the original graph */
             Graph graph;
             std::vector<Node> inputs;
             std::vector<Node> outputs;
+            /** The updates which the function applies, all of them are part of the function */
+            Updates updates;
             std::vector<std::string> unique_symbolics;
+            /** The nodes of graph which are part of the function */
+            NodeSet members;
+            /** The ids in graph of the nodes of the function ordered by id, the position is the local id */
+            std::vector<size_t> node_ids;
 
             GraphFunction(Graph const full_graph,
                           std::vector<Node> const inputs,
                           std::vector<Node> const outputs,
                           Updates extra_updates = Updates(),
-                          bool copy_updates = true);
+                          bool copy_updates = true,
+                          bool as_view = true);
 
 
             GraphFunction(std::string const name,
@@ -32,7 +44,49 @@ namespace md{
                           std::vector<Node> const inputs,
                           std::vector<Node> const outputs,
                           Updates extra_updates = Updates(),
-                          bool copy_updates = true);
+                          bool copy_updates = true,
+                          bool as_view = true);
+
+            /** @brief Returns whether the function refers to the nodes of another graph, rather than owning a copy
+             *
+             * @return
+             */
+            bool is_view() const {
+                return view;
+            }
+
+            /** @brief Returns the number of nodes in the function
+             *
+             * @return
+             */
+            size_t size() const {
+                return node_ids.size();
+            }
+
+            /** @brief Returns all nodes of the function ordered by id
+             *
+             * @return
+             */
+            NodeVec nodes() const;
+
+            /** @brief Returns all nodes of the function which are results of the given operator kind
+             *
+             * @param kind
+             * @return
+             */
+            NodeVec op_nodes(OpKind const kind) const;
+
+            /** @brief Returns the dense id of the node among the nodes of the function
+             *
+             * @param node
+             * @return
+             */
+            size_t local_id(Node const node) const;
+
+            /** @brief Copies the nodes of the function into a graph of its own, if it is a view.
+             * Afterwards graph, inputs, outputs and updates refer to the copy.
+             */
+            void materialize();
 
             /** @brief Applies the function to another graph
              *
@@ -43,6 +97,34 @@ namespace md{
              */
             std::vector<Node> apply(Graph other_graph, std::vector<Node> provided_inputs,
                                     bool apply_updates = true);
+
+            /** @brief Returns the axis along which apply_batched() stacks the examples.
+             * This is the first axis above all of the axes used by the nodes of the function, such that
+             * in memory each example is a contiguous block, or -1 if all four axes are used.
+             *
+             * @return
+             */
+            int batch_axis() const;
+
+            /** @brief Applies the function to a whole batch of examples at once.
+             * Each provided input either has the shape of the input of the function, in which case it is shared
+             * by all examples, or has the size of the batch along batch_axis(), in which case it holds one example
+             * per slice. Instead of copying the function once per example, the nodes which depend on the batched
+             * inputs are rewritten to operate on all of the examples, so the result is a single copy of the function
+             * with each output batched along the same axis.
+             * Only elementwise, reduction, MatrixMul, Reshape, Reorder, Broadcast and Flip operators
+             * can be batched. The updates of the function are not applied.
+             *
+             * @param other_graph
+             * @param provided_inputs
+             * @return
+             */
+            std::vector<Node> apply_batched(Graph other_graph, std::vector<Node> provided_inputs);
+        private:
+            /** Whether graph is the original graph */
+            bool view;
+
+            void materialize(Updates const & extra_updates);
         };
 
         /**
@@ -59,21 +141,45 @@ namespace md{
             Properties props;
             /** Current gradient level */
             unsigned int grad_level = 0;
-            /** The list of all of the nodes */
-            std::vector<std::shared_ptr<NodeData>> nodes;
+            /** The number of nodes when the current differentiation started, only the nodes created since
+             * are named after the messages they carry */
+            size_t diff_start = 0;
+            /** The memory of all operators of the graph, declared before the nodes so that it outlives them */
+            MonotonicArena arena;
+            /** The interning table of all SymInt values used by the nodes */
+            SymIntTable sym_table;
+            /** The storage of all of the nodes */
+            NodeArena nodes;
+            /** The index of all of the edges between the nodes */
+            EdgeIndex edges;
             /** List of all of the updates */
             Updates updates;
+            /** The interning table of all scopes used by the nodes */
+            ScopeTable scopes;
             /** Current group */
-            std::string scope;
-            /** Mapping group name to all Nodes in that group */
-            std::unordered_map<std::string, NodeVec> group_map;
-            /** Mapping operator name to all Nodes who are results of that op */
-            std::unordered_map<std::string, NodeVec> op_map;
+            ScopeId scope;
+            /** Mapping group to all Nodes in that group */
+            std::unordered_map<ScopeId, NodeVec> group_map;
+            /** Mapping operator kind to all Nodes who are results of that op */
+            std::unordered_map<OpKind, NodeVec> op_map;
+            /** Mapping the structural hash of an operator (see AbstractOperator::hash()) to all Nodes with that hash */
+            std::unordered_map<size_t, NodeVec> structure_map;
+            /** The versions and the number of nodes of all live snapshots, oldest first */
+            std::vector<std::pair<size_t, size_t>> snapshots;
+            /** The fields of nodes older than the latest snapshot, saved before they were modified in place */
+            std::vector<NodeRecord> journal;
+            /** The version of the last snapshot taken */
+            size_t last_version;
+            /** The results of backward_diff(), keyed by their grad level and the ids of f, u, w and the checkpoints,
+             * which are returned when the same derivative is requested again instead of propagating it anew */
+            std::map<std::vector<size_t>, NodeVec> derivative_cache;
 
             GraphInternal(std::string name = "graph"):
                     name(name),
                     props(default_properties()),
-                    scope(""){}
+                    nodes(this),
+                    scope(ScopeTable::root),
+                    last_version(0){}
 
             /** @brief Copies the computation of this graph into another
              *
@@ -81,18 +187,51 @@ namespace md{
              * @param mask
              * @return
              */
-            Updates copy_into(Graph new_graph, std::vector<bool> const & mask,
+            Updates copy_into(Graph new_graph, NodeSet const & mask,
                               Updates const & provided,
                               bool allow_input_copies, bool allow_shared_copies,
                               bool copy_updates = true) const;
 
+            /** @brief Copies the masked nodes of this graph into another, same as copy_into(),
+             * but returns the mapping as a dense IdRemap.
+             * The node storage of the new graph is reserved upfront and the provided nodes need not be in the mask.
+             *
+             * @param new_graph
+             * @param mask
+             * @param provided - nodes of this graph which are not copied, but mapped to the given nodes of new_graph
+             * @param allow_input_copies
+             * @param allow_parameter_copies
+             * @param copy_updates
+             * @return
+             */
+            IdRemap remap_into(Graph new_graph, NodeSet const & mask,
+                               Updates const & provided,
+                               bool allow_input_copies, bool allow_parameter_copies,
+                               bool copy_updates = true) const;
+
+            /** @brief Copies the nodes of several disjoint masks of this graph into another in a single pass.
+             * Nodes of one mask may have ancestors in another.
+             *
+             * @param new_graph
+             * @param masks
+             * @param provided
+             * @param allow_input_copies
+             * @param allow_parameter_copies
+             * @param copy_updates
+             * @return
+             */
+            IdRemap copy_masks_into(Graph new_graph, std::vector<NodeSet> const & masks,
+                                    Updates const & provided,
+                                    bool allow_input_copies, bool allow_parameter_copies,
+                                    bool copy_updates = true) const;
+
             /** @brief clones this graph
              *
              * @param mask
              * @param copy_updates
              * @return
              */
-            Graph clone( std::vector<bool> const & mask, bool copy_updates = true) const;
+            Graph clone(NodeSet const & mask, bool copy_updates = true) const;
 
             /** @brief clones this graph
              *
@@ -109,18 +248,63 @@ namespace md{
              * @param copy_updates
              * @return
              */
-            Updates apply(Graph new_graph, std::vector<bool> const & mask,
+            Updates apply(Graph new_graph, NodeSet const & mask,
                           Updates const & provided,
                           bool copy_updates = true, bool allow_shared_copies = true) const;
 
 
+            /** @brief Removes all nodes which are not ancestors of the outputs or of the updates.
+             * The remaining nodes keep their order and are renumbered densely, their operators are recreated
+             * with the new ids and the edges, op_map, group_map and structure_map are rebuilt.
+             * Updates of the graph whose nodes are removed are dropped and the derivative cache is cleared.
+             * Any Node of this graph held elsewhere refers to the old ids and should be translated with the result.
+             *
+             * @param outputs
+             * @param updates
+             * @return For each old id the Node it became, or an empty Node if it was removed
+             */
+            NodeVec compact(NodeVec const & outputs, Updates const & updates = Updates());
+
+            /** @brief Takes a snapshot of the graph, to which it can be rolled back later.
+             * The snapshot shares all of the nodes with the graph, thus its cost does not depend on the graph size.
+             * It remains valid until the graph is rolled back to an older snapshot, it is released or
+             * the graph is compacted.
+             *
+             * @return
+             */
+            Snapshot snapshot();
+
+            /** @brief Rolls back the graph to the snapshot, removing all nodes created after it and undoing
+             * the changes of the older nodes, the updates, the current scope and gradient level.
+             * The cost is proportional to what has changed since the snapshot, not to the graph size.
+             * Snapshots taken after it are released, while the snapshot itself remains valid.
+             * Any Node created after the snapshot and held elsewhere is no longer valid.
+             *
+             * @param snapshot
+             */
+            void rollback(Snapshot const & snapshot);
+
+            /** @brief Releases the snapshot and all snapshots taken after it, once there are no live snapshots
+             * the journal is cleared.
+             *
+             * @param snapshot
+             */
+            void release(Snapshot const & snapshot);
+
+            /** @brief Must be called before modifying the fields of an existing node in place, so that a rollback
+             * can undo the modification. Records the fields only if the node is older than the latest snapshot.
+             *
+             * @param node
+             */
+            void touch(Node const node);
+
             /** @brief Returns a boolean mask over the nodes of the graph, specifiying which nodes are descendants of roots
              *  Includes the roots in the mask as well
              *
              * @param roots
              * @return
              */
-            std::vector<bool> get_descendants_mask(NodeVec const & roots) const;
+            NodeSet get_descendants_mask(NodeVec const & roots) const;
 
             /** @brief Returns a boolean mask over the nodes of the graph, specifiying which nodes are ancestors of leafs
              *  Includes the leafs in the mask as well
@@ -128,7 +312,7 @@ namespace md{
              * @param leafs
              * @return
              */
-            std::vector<bool> get_ancestors_mask(NodeVec const &  leafs) const;
+            NodeSet get_ancestors_mask(NodeVec const &  leafs) const;
 
             /** @brief Returns the intersection of get_ancestors_mask() and get_descendants_mask()
              *
@@ -136,7 +320,28 @@ namespace md{
              * @param leafs
              * @return
              */
-            std::vector<bool> get_flow_tree_mask(NodeVec const & roots, NodeVec const & leafs) const;
+            NodeSet get_flow_tree_mask(NodeVec const & roots, NodeVec const & leafs) const;
+
+            /** @brief Returns the nodes which are both descendants of roots and ancestors of leafs, as a worklist.
+             * Only the ancestors of leafs between the smallest root and the largest leaf are visited,
+             * hence the cost is proportional to them rather than to the size of the graph.
+             *
+             * @param roots
+             * @param leafs
+             * @return
+             */
+            FlowTree get_flow_tree(NodeVec const & roots, NodeVec const & leafs) const;
+
+            /** @brief Returns the flow tree masks of many (roots[i], leafs[i]) pairs at once
+             * All of the queries are carried as bits of a word per node, thus a single forward and
+             * a single backward sweep, over the nodes between the smallest root and the largest leaf, serve them all.
+             *
+             * @param roots
+             * @param leafs
+             * @return
+             */
+            std::vector<NodeSet> get_flow_tree_masks(std::vector<NodeVec> const & roots,
+                                                     std::vector<NodeVec> const & leafs) const;
 
             /** @brief Performs a backward differentiation of f with respect to w at evaluation poins u
              * Formally this computes u^T J_f, where J_f is the Jacobian of f with respect to w (Theano's Lop)
@@ -148,6 +353,33 @@ namespace md{
              */
             NodeVec backward_diff(NodeVec const & f, NodeVec const & u, NodeVec const & w);
 
+            /** @brief Performs a backward differentiation of f with respect to w at evaluation poins u,
+             * trading computation for memory. Only the checkpoints of the forward pass are used by the result,
+             * every other forward node in the flow tree, which the backward pass needs, is recomputed
+             * from them just before its first use, so that its original value can be released early.
+             * The parameters, and the nodes which do not depend on them, are always kept.
+             *
+             * @param f
+             * @param u
+             * @param w
+             * @param checkpoints
+             * @return
+             */
+            NodeVec backward_diff(NodeVec const & f, NodeVec const & u, NodeVec const & w,
+                                  NodeSet const & checkpoints);
+
+            /** @brief Selects up to max_checkpoints nodes of the flow tree from w to f, evenly spaced
+             * in the order of their evaluation, to be kept during a backward_diff() with rematerialization.
+             * If max_checkpoints is 0 the square root of the number of nodes is used, which bounds both
+             * the number of kept and of simultaneously recomputed nodes by it.
+             *
+             * @param f
+             * @param w
+             * @param max_checkpoints
+             * @return
+             */
+            NodeSet select_checkpoints(NodeVec const & f, NodeVec const & w, size_t max_checkpoints = 0) const;
+
             /** @brief Performs a forward differentiation of f with respect to w at evaluation poins v
              * Formally this computes J_f v, where J_f is the Jacobian of f with respect to w (Theano's Rop)
              *
@@ -158,6 +390,93 @@ namespace md{
              */
             NodeVec forward_diff(NodeVec const & f, NodeVec const & v, NodeVec const & w);
 
+            /** @brief Computes the Jacobian-vector products J_f v of f with respect to w for a batch of directions,
+             * where each direction holds one vector for every w (see forward_diff()).
+             * The flow tree from w to f is generated once and the primal nodes are shared by all directions.
+             *
+             * @param f
+             * @param w
+             * @param directions
+             * @return - for every direction the products for every f
+             */
+            std::vector<NodeVec> jvp(NodeVec const & f, NodeVec const & w, std::vector<NodeVec> const & directions);
+
+            /** @brief Computes the vector-Jacobian products u^T J_f of f with respect to w for a batch of directions,
+             * where each direction holds one vector for every f (see backward_diff()).
+             * The flow tree from w to f is generated once and the primal nodes are shared by all directions.
+             *
+             * @param f
+             * @param w
+             * @param directions
+             * @return - for every direction the products for every w
+             */
+            std::vector<NodeVec> vjp(NodeVec const & f, NodeVec const & w, std::vector<NodeVec> const & directions);
+
+            /** @brief Computes the Hessian-vector products H_f v of the scalar f with respect to w for a batch of
+             * directions, where each direction holds one vector for every w. This is done in forward-over-reverse
+             * form - the gradient of f is built only once and every direction adds just its jvp() through it.
+             *
+             * @param f
+             * @param w
+             * @param directions
+             * @return - for every direction the products for every w
+             */
+            std::vector<NodeVec> hvp(Node const f, NodeVec const & w, std::vector<NodeVec> const & directions);
+
+            /** @brief Performs the backward_diff() of every f[k] at u[k] with respect to w concurrently.
+             * The flow trees of all of them are found in a single sweep (see get_flow_tree_masks()), then each
+             * is copied into its own GraphBuilder and differentiated there on one of the threads.
+             * The results are merged in the order of k (see build_concurrently()), so the resulting graph does not
+             * depend on the scheduling and the nodes of the forward pass are not duplicated.
+             *
+             * @param f
+             * @param u
+             * @param w
+             * @param threads - the number of threads, 0 means std::thread::hardware_concurrency()
+             * @return - for every k the derivatives for every w
+             */
+            std::vector<NodeVec> backward_diff_concurrently(std::vector<NodeVec> const & f,
+                                                            std::vector<NodeVec> const & u,
+                                                            NodeVec const & w, size_t threads = 0);
+
+            /** @brief Performs the forward_diff() of f with respect to w at every v[k] concurrently,
+             * the same way as backward_diff_concurrently().
+             *
+             * @param f
+             * @param v
+             * @param w
+             * @param threads - the number of threads, 0 means std::thread::hardware_concurrency()
+             * @return - for every k the derivatives of every f
+             */
+            std::vector<NodeVec> forward_diff_concurrently(NodeVec const & f,
+                                                           std::vector<NodeVec> const & v,
+                                                           NodeVec const & w, size_t threads = 0);
+
+            /** @brief Returns the cheaper mode for the Jacobian of f with respect to w, estimated from the
+             * symbolic number of elements - forward mode needs a tangent for every element of w and reverse mode
+             * a cotangent for every element of f. The counts are compared for large values of the symbolic
+             * dimensions and reverse mode is preferred when neither is smaller.
+             *
+             * @param f
+             * @param w
+             * @return - either FORWARD_MODE or REVERSE_MODE
+             */
+            DiffMode jacobian_mode(Node const f, NodeVec const & w) const;
+
+            /** @brief Calculates the Jacobian of f with respect to each of w, as a matrix with a row for every
+             * element of f and a column for every element of w[i], both flattened in memory order.
+             * All of the tangents (or cotangents) are propagated at once, with the unit directions batched along
+             * a free axis (see GraphFunction::apply_batched()), so the graph does not grow with their number.
+             * The derivatives along a placeholder of the directions are built in a GraphBuilder, from which only
+             * the results are merged, hence the placeholder is not added to the graph.
+             *
+             * @param f
+             * @param w
+             * @param mode - if AUTOMATIC_MODE the one of jacobian_mode() is used
+             * @return
+             */
+            NodeVec jacobian(Node const f, NodeVec const & w, DiffMode mode = AUTOMATIC_MODE);
+
             /** @brief Returns the name of the parent group
              *
              * @param full_name
@@ -188,6 +507,8 @@ namespace md{
             void reset_scope();
 
             /** @brief Creates a new dervied node from the Operator. This is strictly for internal usage.
+             * If a Node which is symbolically equivalent to the result of the Operator already exists
+             * it is returned instead, without creating a new one.
              *
              * @param op
              * @param name
@@ -195,6 +516,15 @@ namespace md{
              */
             Node derived_node(Operator op, std::string name = "Derived");
 
+            /** @brief Creates a new derived node from the Operator, even if an equivalent Node exists.
+             * This is used for recomputing nodes, otherwise use derived_node().
+             *
+             * @param op
+             * @param name
+             * @return
+             */
+            Node duplicate_node(Operator op, std::string name = "Derived");
+
             /** @brief Finds a Node which exists and is symbolically equivalent to the result of the Operator.
              * If such node does not exist returns empty node.
              *
@@ -203,6 +533,16 @@ namespace md{
              */
             Node find_same_node(Operator op);
 
+            /** @brief Finds a Node which exists and is symbolically equivalent to the result of the Operator,
+             * using an already computed AbstractOperator::hash() of the Operator.
+             * If such node does not exist returns empty node.
+             *
+             * @param op
+             * @param hash
+             * @return
+             */
+            Node find_same_node(Operator op, size_t hash);
+
             /** @brief Looks up the max_float and max_int and limits the data_type accordingly
              *
              * @param data_type
@@ -611,8 +951,40 @@ namespace md{
              * @return
              */
             Node random_normal(Shape shape);
+        private:
+            /** Adds the result of the Operator as a new node, given the structural hash of the Operator */
+            Node insert_node(Operator op, std::string const & name, size_t const hash);
+
+            /** The backward_diff() with rematerialization when checkpoints is not nullptr,
+             * starting from a copy of the flow tree when it is not nullptr */
+            NodeVec backward_diff(NodeVec const & f, NodeVec const & u, NodeVec const & w,
+                                  NodeSet const * checkpoints, FlowTree const * shared_tree);
+
+            /** The forward_diff() over the flow tree when it is not nullptr */
+            NodeVec forward_diff(NodeVec const & f, NodeVec const & v, NodeVec const & w,
+                                 FlowTree const * shared_tree);
         };
 
+        /** @brief Creates an Operator of type T in the arena of the graph.
+         * The operator must not outlive the graph.
+         *
+         * @param graph
+         * @param args - the remaining arguments of the constructor of T
+         * @return
+         */
+        template <typename T, typename... Args>
+        std::shared_ptr<T> make_operator(GraphInPtr const graph, Args&&... args){
+            return std::allocate_shared<T>(ArenaAllocator<T>(&graph->arena), graph, std::forward<Args>(args)...);
+        }
+
+        inline NodeData* Node::unwrap() const{
+            if (empty()) {
+                logger("XXX::node::XXX")->error("Trying to access the NodeData of an empty Node");
+                return nullptr;
+            }
+            return graph->nodes.data(id);
+        }
+
         // Used for wrapping any outside variables in a unified way
         inline Node wrap(SymInt value, Graph g){
             return g->sym_int_node(value);
@@ -8,6 +8,12 @@
 // External includes
 #include "type_traits"
 #include "string"
+#include "deque"
+#include "map"
+#include "thread"
+#include "atomic"
+#include "mutex"
+#include "functional"
 #include "symbolic_integers.h"
 #include "spdlog/spdlog.h"
 #include "spdlog/sinks/dist_sink.h"
@@ -32,15 +38,26 @@ namespace md{
 }
 
 #include "enums.h"
+#include "op_kinds.h"
 #include "definitions.h"
 #include "props.h"
 //#include "shared.h"
 #include "exceptions.h"
 #include "export.h"
+#include "sym_table.h"
+#include "scope_table.h"
+#include "arena.h"
 #include "node.h"
+#include "edges.h"
+#include "node_set.h"
+#include "flow_tree.h"
+#include "id_remap.h"
+#include "snapshot.h"
 #include "utils.h"
 #include "print.h"
 #include "graph.h"
+#include "builder.h"
+#include "subroutine.h"
 #include "api.h"
 #include "operators.h"
 #include "backend.h"
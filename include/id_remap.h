@@ -0,0 +1,94 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#ifndef METADIFF_GRAPH_IR_ID_REMAP_H
+#define METADIFF_GRAPH_IR_ID_REMAP_H
+
+namespace md{
+    namespace gir{
+        /**
+         * A dense mapping from the ids of the nodes of a source graph to the ids of nodes in a target graph,
+         * indexed by the source id. It is the result of copying nodes between graphs and, unlike Updates,
+         * each lookup is a single load and a lookup never inserts anything.
+         */
+        class IdRemap {
+        public:
+            /** The value of the source ids which are not mapped */
+            static size_t const missing = std::numeric_limits<size_t>::max();
+            /** The graph of the mapped nodes */
+            GraphInPtr target;
+
+            IdRemap():
+                    target(nullptr) {};
+
+            IdRemap(GraphInPtr const target, size_t const n):
+                    target(target),
+                    ids(n, missing) {};
+
+            /** @brief Returns the number of source ids the mapping spans
+             *
+             * @return
+             */
+            size_t size() const {
+                return ids.size();
+            }
+
+            /** @brief Returns whether the source id is mapped
+             *
+             * @param id
+             * @return
+             */
+            bool contains(size_t const id) const {
+                return id < ids.size() and ids[id] != missing;
+            }
+
+            /** @brief Returns the target id of the source id, or missing
+             *
+             * @param id
+             * @return
+             */
+            size_t operator[](size_t const id) const {
+                return ids[id];
+            }
+
+            /** @brief Returns the target Node of the source id, which must be mapped
+             *
+             * @param id
+             * @return
+             */
+            Node node(size_t const id) const {
+                return Node(target, ids[id]);
+            }
+
+            /** @brief Maps the source id to the target id
+             *
+             * @param id
+             * @param target_id
+             */
+            void set(size_t const id, size_t const target_id) {
+                ids[id] = target_id;
+            }
+
+            /** @brief Returns the mapping as Updates, from the nodes of the source to the nodes of the target
+             *
+             * @param source
+             * @return
+             */
+            Updates to_updates(GraphInPtr const source) const {
+                Updates result;
+                for(size_t i = 0; i < ids.size(); ++i){
+                    if(ids[i] != missing){
+                        result[Node(source, i)] = Node(target, ids[i]);
+                    }
+                }
+                return result;
+            }
+
+        private:
+            /** The target id of each source id */
+            std::vector<size_t> ids;
+        };
+    }
+}
+#endif //METADIFF_GRAPH_IR_ID_REMAP_H
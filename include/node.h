@@ -11,13 +11,12 @@ namespace md{
         /** The main storage class for all data on each node of the graph */
         class NodeData {
         public:
-            std::weak_ptr<GraphInternal> const graph;
+            GraphInPtr const graph;
             size_t id;
             std::string name;
             DataType data_type;
-            Shape shape;
+            SymShape shape;
             Operator op;
-            NodeVec children;
 
             bool is_input_dependent;
             bool is_differentiable;
@@ -27,56 +26,69 @@ namespace md{
             MatrixFill matrix_fill;
 
             unsigned int grad_level;
+            /** Whether the node was created by GraphInternal::duplicate_node(), hence its copies are kept apart
+             * from the nodes they are equal to as well */
+            bool duplicate = false;
             Device device;
 //            ExecutionData execution;
 
-            std::string scope;
+            /** The scope of the node in the ScopeTable of its graph */
+            ScopeId scope = ScopeTable::root;
 
-            NodeData(std::weak_ptr<GraphInternal> const graph, Device const device) :
+            NodeData(GraphInPtr const graph, Device const device) :
                     graph(graph),
                     device(device) { }
 
-            NodeData(std::weak_ptr<GraphInternal> const graph,
+            NodeData(GraphInPtr const graph,
                      size_t id,
                      std::string name,
                      Device device,
                      Operator op,
                      unsigned int grad_level,
-                     std::string scope);
+                     ScopeId scope);
         };
 
         inline bool operator==(NodeData const & data1, NodeData const & data2){
-            if(data1.graph.expired() or data2.graph.expired()){
-                return false;
-            }
-            return data1.graph.lock() == data2.graph.lock() and data1.id == data2.id;
+            return data1.graph == data2.graph and data1.id == data2.id;
         }
 
 
-        /** This is the API wrapper around the internal storage for each node - NodeData */
+        /** This is the API wrapper around the internal storage for each node - NodeData.
+         * It is just a handle of the owning graph and the id of the node in it, so copying
+         * and dereferencing it never touches any reference counts.
+         */
         class Node {
         public:
-            std::weak_ptr<NodeData> ptr;
+            /** The owning graph, nullptr for an empty Node */
+            GraphInPtr graph;
+            /** The id of the node in the NodeArena of the graph */
+            size_t id;
 
-            Node() {};
+            Node():
+                    graph(nullptr), id(0) {};
 
-            Node(std::shared_ptr<NodeData> const ptr) :
-                    ptr(ptr) { };
+            Node(GraphInPtr const graph, size_t const id) :
+                    graph(graph), id(id) { };
 
-            Node(Node const &node) :
-                    ptr(node.ptr) { };
+            /** @brief Returns whether this Node does not refer to any NodeData
+             *
+             * @return
+             */
+            bool empty() const {
+                return graph == nullptr;
+            }
 
-            /** @brief Unwraps the ptr to the underlying NodeData
+            /** @brief Unwraps the handle to the underlying NodeData
              *
-             * @return std::shared_ptr<NodeData> or throws an error if the pointer has expired.
+             * @return NodeData* or logs an error and returns nullptr if the Node is empty.
              */
-            std::shared_ptr<NodeData> unwrap() const;
+            NodeData* unwrap() const;
 
             /** @brief See unwrap()
              *
              * @return
              */
-            std::shared_ptr<NodeData> operator->() const{
+            NodeData* operator->() const{
                 return unwrap();
             }
 
@@ -92,6 +104,147 @@ namespace md{
              */
             int order() const;
         };
+
+        /** A read only view over a contiguous range of Nodes, which does not own or copy them.
+         * It is valid only as long as the storage it refers to is not modified.
+         */
+        class NodeView {
+        public:
+            NodeView():
+                    first(nullptr), last(nullptr) {};
+
+            NodeView(Node const * const first, Node const * const last):
+                    first(first), last(last) {};
+
+            NodeView(NodeVec const & nodes):
+                    first(nodes.data()), last(nodes.data() + nodes.size()) {};
+
+            Node const * begin() const {
+                return first;
+            }
+
+            Node const * end() const {
+                return last;
+            }
+
+            size_t size() const {
+                return last - first;
+            }
+
+            bool empty() const {
+                return first == last;
+            }
+
+            Node const & operator[](size_t const index) const {
+                return first[index];
+            }
+
+            /** @brief Copies the Nodes of the view into a new NodeVec
+             *
+             * @return
+             */
+            NodeVec vec() const {
+                return NodeVec(first, last);
+            }
+
+        private:
+            Node const * first;
+            Node const * last;
+        };
+
+        /** The storage of all NodeData of a single graph.
+         * The NodeData are allocated in fixed sized blocks, thus they never move once created
+         * and a Node can address them only by their id.
+         */
+        class NodeArena {
+        public:
+            /** Log2 of the number of NodeData in a single block */
+            static size_t const block_bits = 10;
+            /** Number of NodeData in a single block */
+            static size_t const block_size = size_t(1) << block_bits;
+
+            NodeArena(GraphInPtr const graph):
+                    graph(graph), count(0) {};
+
+            NodeArena(NodeArena const & arena) = delete;
+
+            NodeArena& operator=(NodeArena const & arena) = delete;
+
+            ~NodeArena();
+
+            /** @brief Returns the number of nodes in the arena
+             *
+             * @return
+             */
+            size_t size() const {
+                return count;
+            }
+
+            /** @brief Returns the Node with the given id
+             *
+             * @param id
+             * @return
+             */
+            Node operator[](size_t const id) const {
+                return Node(graph, id);
+            }
+
+            /** @brief Returns the last Node in the arena
+             *
+             * @return
+             */
+            Node back() const {
+                return Node(graph, count - 1);
+            }
+
+            /** @brief Returns the NodeData with the given id
+             *
+             * @param id
+             * @return
+             */
+            NodeData* data(size_t const id) const {
+                return blocks[id >> block_bits] + (id & (block_size - 1));
+            }
+
+            /** @brief Constructs a new NodeData at the end of the arena, with id equal to the current size
+             *
+             * @param name
+             * @param device
+             * @param op
+             * @param grad_level
+             * @param scope
+             * @return
+             */
+            Node emplace(std::string name, Device device, Operator op,
+                         unsigned int grad_level, ScopeId scope);
+
+            /** @brief Allocates enough blocks to hold n nodes without further allocations
+             *
+             * @param n
+             */
+            void reserve(size_t const n);
+
+            /** @brief Moves the NodeData with id from into the slot with id to, which must not be larger,
+             * destroying the NodeData which was there. The moved NodeData gets the id to.
+             *
+             * @param from
+             * @param to
+             */
+            void relocate(size_t const from, size_t const to);
+
+            /** @brief Destroys all NodeData with id not smaller than n
+             *
+             * @param n
+             */
+            void truncate(size_t const n);
+        private:
+            /** The owning graph */
+            GraphInPtr const graph;
+            /** The blocks of raw memory */
+            std::vector<NodeData*> blocks;
+            /** The number of constructed NodeData */
+            size_t count;
+        };
     }
 }
 
@@ -101,7 +254,7 @@ namespace std {
     public :
         size_t operator()(md::gir::Node const & node ) const
         {
-            return hash<std::shared_ptr<md::gir::NodeData>>()(node.ptr.lock());
+            return hash<md::gir::GraphInPtr>()(node.graph) ^ (hash<size_t>()(node.id) << 1);
         }
     };
 
@@ -110,10 +263,10 @@ namespace std {
     public :
         typedef md::gir::Node T;
         bool operator()( const T& lhs, const T& rhs ) const {
-            if(lhs.ptr.expired() or rhs.ptr.expired()){
+            if(lhs.empty() or rhs.empty()){
                 return false;
             } else {
-                return lhs.unwrap() == rhs.unwrap();
+                return lhs.graph == rhs.graph and lhs.id == rhs.id;
             }
         }
     };
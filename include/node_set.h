@@ -0,0 +1,280 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#ifndef METADIFF_GRAPH_IR_NODE_SET_H
+#define METADIFF_GRAPH_IR_NODE_SET_H
+
+namespace md{
+    namespace gir{
+        /**
+         * A dense set of node ids of a single graph, stored as a bitset of 64-bit words.
+         * Unions and intersections operate on whole words in plain loops, which the compiler vectorizes,
+         * and the set bits are iterated by skipping empty words and counting trailing zeros.
+         * Ids not smaller than size() are never in the set, so a set stays valid while the graph grows.
+         * The bits in the last word past size() are kept at zero.
+         */
+        class NodeSet {
+        public:
+            typedef uint64_t Word;
+            static size_t const word_bits = 64;
+
+            /** Iterates over the ids in the set in increasing order */
+            class const_iterator {
+            public:
+                NodeSet const * set;
+                size_t id;
+
+                const_iterator(NodeSet const * set, size_t const id):
+                        set(set), id(id) {};
+
+                size_t operator*() const {
+                    return id;
+                }
+
+                const_iterator& operator++() {
+                    id = set->next(id + 1);
+                    return *this;
+                }
+
+                bool operator==(const_iterator const & other) const {
+                    return id == other.id;
+                }
+
+                bool operator!=(const_iterator const & other) const {
+                    return id != other.id;
+                }
+            };
+
+            NodeSet():
+                    n(0) {};
+
+            explicit NodeSet(size_t const n, bool const value = false):
+                    n(n),
+                    words(num_words(n), value ? ~Word(0) : Word(0)) {
+                clear_tail();
+            };
+
+            /** @brief Returns the number of ids the set spans (not the number of ids in it)
+             *
+             * @return
+             */
+            size_t size() const {
+                return n;
+            }
+
+            /** @brief Changes the number of ids the set spans, the new ids are not in the set
+             *
+             * @param new_size
+             */
+            void resize(size_t const new_size){
+                n = new_size;
+                words.resize(num_words(n), 0);
+                clear_tail();
+            }
+
+            bool operator[](size_t const id) const {
+                return id < n and ((words[id / word_bits] >> (id % word_bits)) & 1);
+            }
+
+            bool contains(size_t const id) const {
+                return (*this)[id];
+            }
+
+            void insert(size_t const id){
+                words[id / word_bits] |= Word(1) << (id % word_bits);
+            }
+
+            void erase(size_t const id){
+                words[id / word_bits] &= ~(Word(1) << (id % word_bits));
+            }
+
+            /** @brief Returns the number of ids in the set
+             *
+             * @return
+             */
+            size_t count() const {
+                size_t total = 0;
+                for(size_t i = 0; i < words.size(); ++i){
+                    total += __builtin_popcountll(words[i]);
+                }
+                return total;
+            }
+
+            /** @brief Returns true if there are no ids in the set
+             *
+             * @return
+             */
+            bool none() const {
+                for(size_t i = 0; i < words.size(); ++i){
+                    if(words[i] != 0){
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            /** @brief Returns the smallest id in the set which is not smaller than from, or size() if there is none
+             *
+             * @param from
+             * @return
+             */
+            size_t next(size_t const from) const {
+                if(from >= n){
+                    return n;
+                }
+                size_t w = from / word_bits;
+                Word word = words[w] & (~Word(0) << (from % word_bits));
+                while(word == 0){
+                    if(++w == words.size()){
+                        return n;
+                    }
+                    word = words[w];
+                }
+                return w * word_bits + __builtin_ctzll(word);
+            }
+
+            /** @brief Returns the largest id in the set which is smaller than before, or size() if there is none
+             *
+             * @param before
+             * @return
+             */
+            size_t previous(size_t const before) const {
+                size_t const last = before < n ? before : n;
+                if(last == 0){
+                    return n;
+                }
+                size_t w = (last - 1) / word_bits;
+                size_t const shift = word_bits - 1 - (last - 1) % word_bits;
+                Word word = words[w] & (~Word(0) >> shift);
+                while(word == 0){
+                    if(w-- == 0){
+                        return n;
+                    }
+                    word = words[w];
+                }
+                return w * word_bits + word_bits - 1 - __builtin_clzll(word);
+            }
+
+            const_iterator begin() const {
+                return const_iterator(this, next(0));
+            }
+
+            const_iterator end() const {
+                return const_iterator(this, n);
+            }
+
+            /** @brief Adds all ids of the other set, growing this set if the other spans more ids
+             *
+             * @param other
+             * @return
+             */
+            NodeSet& operator|=(NodeSet const & other){
+                if(other.n > n){
+                    resize(other.n);
+                }
+                Word * const dst = words.data();
+                Word const * const src = other.words.data();
+                size_t const m = other.words.size();
+                for(size_t i = 0; i < m; ++i){
+                    dst[i] |= src[i];
+                }
+                return *this;
+            }
+
+            /** @brief Keeps only the ids which are also in the other set
+             *
+             * @param other
+             * @return
+             */
+            NodeSet& operator&=(NodeSet const & other){
+                Word * const dst = words.data();
+                Word const * const src = other.words.data();
+                size_t const m = words.size() < other.words.size() ? words.size() : other.words.size();
+                for(size_t i = 0; i < m; ++i){
+                    dst[i] &= src[i];
+                }
+                for(size_t i = m; i < words.size(); ++i){
+                    dst[i] = 0;
+                }
+                return *this;
+            }
+
+            /** @brief Removes all ids which are in the other set
+             *
+             * @param other
+             * @return
+             */
+            NodeSet& operator-=(NodeSet const & other){
+                Word * const dst = words.data();
+                Word const * const src = other.words.data();
+                size_t const m = words.size() < other.words.size() ? words.size() : other.words.size();
+                for(size_t i = 0; i < m; ++i){
+                    dst[i] &= ~src[i];
+                }
+                return *this;
+            }
+
+            NodeSet operator|(NodeSet const & other) const {
+                NodeSet result = *this;
+                return result |= other;
+            }
+
+            NodeSet operator&(NodeSet const & other) const {
+                NodeSet result = *this;
+                return result &= other;
+            }
+
+            NodeSet operator-(NodeSet const & other) const {
+                NodeSet result = *this;
+                return result -= other;
+            }
+
+            bool operator==(NodeSet const & other) const {
+                return n == other.n and words == other.words;
+            }
+
+            bool operator!=(NodeSet const & other) const {
+                return not (*this == other);
+            }
+
+            /** @brief Returns the ids in the set in increasing order
+             *
+             * @return
+             */
+            std::vector<size_t> ids() const {
+                std::vector<size_t> result;
+                result.reserve(count());
+                for(auto id: *this){
+                    result.push_back(id);
+                }
+                return result;
+            }
+
+            /** @brief Direct access to the words of the bitset
+             *
+             * @return
+             */
+            std::vector<Word> const & data() const {
+                return words;
+            }
+
+        private:
+            /** The number of ids the set spans */
+            size_t n;
+            /** The bits of the set, id i is bit (i % 64) of words[i / 64] */
+            std::vector<Word> words;
+
+            static size_t num_words(size_t const n){
+                return (n + word_bits - 1) / word_bits;
+            }
+
+            void clear_tail(){
+                if(n % word_bits != 0){
+                    words.back() &= ~Word(0) >> (word_bits - n % word_bits);
+                }
+            }
+        };
+    }
+}
+#endif //METADIFF_GRAPH_IR_NODE_SET_H
@@ -0,0 +1,67 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#ifndef METADIFF_GRAPH_IR_OP_KINDS_H
+#define METADIFF_GRAPH_IR_OP_KINDS_H
+
+/** The names of all of the builtin operators, each expanded with the macro X */
+#define GIR_OPERATOR_KINDS(X) \
+    X(Abs) X(Add) X(Alias) X(AllTrue) X(AnyTrue) X(ApproximatelyEquals) X(BinaryCrossEntropyLogits) \
+    X(Broadcast) X(Cast) X(CategoricalCrossEntropyLogits) X(Cholesky) X(CholeskyBackwardDiff) \
+    X(CholeskyForwardDiff) X(ConstantValue) X(Cos) X(Cosh) X(Cot) X(Coth) X(Determinant) X(Diagonal) \
+    X(Division) X(Equals) X(Exp) X(Eye) X(Flip) X(GreaterThan) X(GreaterThanOrEqual) X(Guard) X(Index) \
+    X(Input) X(IntDiv) X(IntMod) X(IsInf) X(IsNaN) X(Kronecker) X(LU) X(LessThan) X(LessThanOrEqual) \
+    X(Log) X(Log10) X(Log1p) X(LogDeterminant) X(LogSumExp) X(LogToFile) X(LogicalAnd) X(LogicalNot) \
+    X(LogicalOr) X(LowerTriangular) X(MakeConstant) X(MatrixInverse) X(MatrixInverseMul) X(MatrixMul) \
+    X(MaxMinAndArgMaxMin) X(Mean) X(Mul) X(MultiOutputIndex) X(Neg) X(NotEquals) X(Parameter) X(Pow) \
+    X(Print) X(Product) X(QR) X(RandomNormal) X(RandomUniform) X(Range) X(Reorder) X(Reshape) \
+    X(Retrieve) X(SVD) X(Select) X(Sigmoid) X(Sin) X(Sinh) X(Slice) X(Softmax) X(Softplus) \
+    X(SortAndArgSort) X(Sqrt) X(Square) X(SubRoutine) X(Sum) X(SymIntWrapper) X(Tan) X(Tanh) X(Trace) \
+    X(UpperTriangular) X(Variance)
+
+namespace md{
+    namespace gir{
+#define GIR_OPERATOR_KIND_ENUM(NAME) NAME,
+        /** The kind of an Operator, which allows dispatching with a switch instead of comparing names.
+         * Every builtin operator has its own value, operators defined outside of the library
+         * get a value of at least OpKind::Custom when their name is first registered.
+         */
+        enum class OpKind : uint16_t {
+            /** The kind of an operator which has not been constructed with a name */
+            Undefined = 0,
+            GIR_OPERATOR_KINDS(GIR_OPERATOR_KIND_ENUM)
+            /** The first value of the kinds registered at runtime */
+            Custom
+        };
+#undef GIR_OPERATOR_KIND_ENUM
+
+        /** @brief Returns the kind with the name, registering a new custom kind if there is none.
+         * This is thread safe.
+         *
+         * @param name
+         * @return
+         */
+        OpKind op_kind(std::string const & name);
+
+        /** @brief Returns the name of the kind.
+         * The reference is valid for the lifetime of the program, so operators can keep it instead of a copy.
+         *
+         * @param kind
+         * @return
+         */
+        std::string const & op_kind_name(OpKind const kind);
+    }
+}
+
+namespace std {
+    template <>
+    class hash<md::gir::OpKind>{
+    public :
+        size_t operator()(md::gir::OpKind const & kind) const
+        {
+            return hash<uint16_t>()(static_cast<uint16_t>(kind));
+        }
+    };
+}
+#endif //METADIFF_GRAPH_IR_OP_KINDS_H
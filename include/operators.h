@@ -19,6 +19,7 @@
 #include "operators/index.h"
 #include "operators/debug.h"
 #include "operators/optimized.h"
+#include "operators/subroutine.h"
 
 
 #endif //METADIFF_GRAPH_IR_OPERATORS_H
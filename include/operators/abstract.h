@@ -15,18 +15,45 @@ namespace md {
             protected:
                 /** Pointer to the owning GraphInternal */
                 GraphInPtr const graph;
+                /** The memoized result of get_interned_shape() */
+                mutable SymShape interned_shape;
+                /** The number of parents and of all ancestors, or -1 before bind_inputs() */
+                mutable int num_parents = -1;
+                mutable int num_ancestors = -1;
+                /** The ancestors (parents followed by arguments) when there are only a few of them */
+                mutable std::array<Node, 3> inline_inputs;
+                /** The ancestors when they do not fit in inline_inputs */
+                mutable NodeVec spilled_inputs;
+
+                /** @brief Collects the parents and arguments once, in the storage used by the views
+                 *
+                 */
+                void bind_inputs() const;
+
+                Node const * inputs() const {
+                    if (num_ancestors < 0) {
+                        bind_inputs();
+                    }
+                    return static_cast<size_t>(num_ancestors) <= inline_inputs.size() ? inline_inputs.data() : spilled_inputs.data();
+                }
 
                 /** This should never be called directly, it exists ONLY for virtual inheritance purposes */
-                AbstractOperator():  graph(nullptr), name("") {};
+                AbstractOperator():  graph(nullptr), kind(OpKind::Undefined), name(op_kind_name(kind)) {};
             public:
-                /** Unique name of the concrete Operator class */
-                std::string const name;
+                /** The kind of the concrete Operator class */
+                OpKind const kind;
+                /** Unique name of the concrete Operator class, the same for all operators of the kind */
+                std::string const & name;
                 /** Pointer to the output Node of the operator */
                 Node result;
 
                 /** Note that the output Node should always be set after the construction of the Operator */
-                AbstractOperator(GraphInPtr const graph, std::string const name) :
-                        graph(graph), name(name){};
+                AbstractOperator(GraphInPtr const graph, OpKind const kind) :
+                        graph(graph), kind(kind), name(op_kind_name(kind)){};
+
+                /** Used by operators defined outside of the library, which register their name as a custom OpKind */
+                AbstractOperator(GraphInPtr const graph, std::string const & name) :
+                        AbstractOperator(graph, op_kind(name)){};
 
                 /** @brief Copies the Operator to the new graph with the provided ancestors
                  *
@@ -48,6 +75,20 @@ namespace md {
                  */
                 virtual Shape get_shape() const = 0;
 
+                /** @brief Returns the Shape for the output Node, interned in the SymIntTable of the graph.
+                 * The shape inference runs only once per Operator, later calls return the memoized result.
+                 *
+                 * @return
+                 */
+                SymShape const & get_interned_shape() const;
+
+                /** @brief Infers the interned Shape for the output Node, called once by get_interned_shape().
+                 * The default implementation interns get_shape().
+                 *
+                 * @return
+                 */
+                virtual SymShape infer_interned_shape() const;
+
                 /** @brief Calculates if the output Node is input dependent based on its ancestors
                  * The default implementation returns true if any of the ancestors is input dependent.
                  *
@@ -89,12 +130,42 @@ namespace md {
                  */
                 virtual NodeVec get_ancestors() const;
 
+                /** @brief Returns a view of get_parents(), which does not allocate.
+                 * The parents are collected on the first call to any of the views,
+                 * so they should be called only once the operator is fully constructed.
+                 *
+                 * @return
+                 */
+                NodeView parents_view() const {
+                    Node const * const first = inputs();
+                    return NodeView(first, first + num_parents);
+                }
+
+                /** @brief Returns a view of get_arguments(), which does not allocate
+                 *
+                 * @return
+                 */
+                NodeView arguments_view() const {
+                    Node const * const first = inputs();
+                    return NodeView(first + num_parents, first + num_ancestors);
+                }
+
+                /** @brief Returns a view of get_ancestors(), which does not allocate
+                 *
+                 * @return
+                 */
+                NodeView ancestors_view() const {
+                    Node const * const first = inputs();
+                    return NodeView(first, first + num_ancestors);
+                }
+
                 /** @brief Generates and sends the backward differentiation messages to all parents using the messages incoming to the output Node
+                 * The messages are indexed by the position of the nodes in the flow tree.
                  *
                  * @param messages
                  * @param flow_tree
                  */
-                void backward_diff(std::vector<NodeVec> & derivative_messages, std::vector<bool>& flow_tree);
+                void backward_diff(std::vector<NodeVec> & derivative_messages, FlowTree const & flow_tree);
 
                 /** @brief Returns the backward diferentiation message to the parent at the index specified
                  *
@@ -113,11 +184,12 @@ namespace md {
                 virtual Node backward_diff_combine(NodeVec & incoming_derivatives) const;
 
                 /** @brief Combines all of the parent_derivatives apropirately and computes the derivative of the output Node
+                 * The derivatives are indexed by the position of the nodes in the flow tree.
                  *
-                 * @param messages
+                 * @param all_derivatives
                  * @param flow_tree
                  */
-                void forward_diff(NodeVec & all_derivatives);
+                void forward_diff(NodeVec & all_derivatives, FlowTree const & flow_tree);
 
                 /** @brief Returns the forward diferentiation message from the parent at the index specified
                  *
@@ -136,7 +208,10 @@ namespace md {
                 virtual Node forward_diff_combine(NodeVec & incoming_derivatives) const;
 
                 /** @brief Returns whether the Operator op is symbolically equivalent to this one.
-                 * TODO This together with find_same_node() and symbolic_equals() still need to be implemented well
+                 * Equivalent operators are of the same kind, have exactly the same ancestors and the same attributes,
+                 * which allows GraphInternal::derived_node() to return the existing Node instead of creating a new one.
+                 * The default implementation returns false, which is what operators that are not a deterministic
+                 * function of their ancestors and attributes (inputs, random values, monitors) should keep.
                  *
                  * @param op
                  * @return
@@ -144,6 +219,21 @@ namespace md {
                 virtual bool equals(Operator const op) const{
                     return false;
                 }
+
+                /** @brief Returns a hash of the Operator, such that equivalent operators (see equals()) have the same hash.
+                 * The default implementation combines the kind with the ids of the ancestors in order,
+                 * the attributes are compared only by equals().
+                 *
+                 * @return
+                 */
+                virtual size_t hash() const;
+
+                /** @brief Returns whether the Operator op has the same kind and exactly the same ancestors, in order
+                 *
+                 * @param op
+                 * @return
+                 */
+                bool same_ancestors(Operator const op) const;
             };
 
 
@@ -171,6 +261,11 @@ namespace md {
 
             class InputOperator: public virtual OrphanOperator {
             public:
+                /** Inputs are never equal to each other, so each gets its own bucket in the structure map */
+                size_t hash() const {
+                    return std::hash<AbstractOperator const *>()(this);
+                }
+
                 bool is_input_dependent() const{
                     return true;
                 }
@@ -233,7 +328,11 @@ namespace md {
             class ElementwiseOperator: public virtual AbstractOperator{
             public:
                 Shape get_shape() const {
-                    return get_parents()[0]->shape;
+                    return parents_view()[0]->shape;
+                }
+
+                SymShape infer_interned_shape() const {
+                    return parents_view()[0]->shape;
                 }
             };
 
@@ -13,11 +13,11 @@ namespace md {
             public:
                 std::vector<bool> neg;
                 Add(GraphInPtr graph, NodeVec parents, std::vector<bool> neg) :
-                        AbstractOperator(graph, "Add"), AssociativeOperator(parents),
+                        AbstractOperator(graph, OpKind::Add), AssociativeOperator(parents),
                         neg(neg){}
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Add>(graph, ancestors, neg);
+                    return make_operator<Add>(graph, ancestors, neg);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index){
@@ -28,41 +28,23 @@ namespace md {
                     return backward_diff_parent(parent_derivatives[index], index);
                 }
 
-//                bool equals(Operator const op) const {
-//                    if (name == op->name) {
-//                        bool check[parents.size()];
-//                        for (int i = 0; i < parents.size(); i++) {
-//                            check[i] = false;
-//                        }
-//                        if (parents.size() != op->get_parents().size()) {
-//                            return false;
-//                        }
-//                        for (int i = 0; i < parents.size(); i++) {
-//                            Node parent = op->get_parents()[i];
-//                            int j = 0;
-//                            for (; j < parents.size(); j++) {
-//                                if (symbolic_equals(parent, parents[j]) and not check[j]) {
-//                                    check[j] = true;
-//                                    break;
-//                                }
-//                            }
-//                            if (j == parents.size()) {
-//                                return false;
-//                            }
-//                        }
-//                    }
-//                    return false;
-//                }
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const Add>(op);
+                        return neg == cast_op->neg;
+                    }
+                    return false;
+                }
             };
 
 //            /** Negation */
 //            class Neg : public UnaryElementwiseOperator {
 //            public:
 //                Neg(GraphInPtr graph, Node parent) :
-//                        AbstractOperator(graph, "Neg"), UnaryOperator(parent) {};
+//                        AbstractOperator(graph, OpKind::Neg), UnaryOperator(parent) {};
 //
 //                Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-//                    return std::make_shared<Neg>(graph, ancestors[0]);
+//                    return make_operator<Neg>(graph, ancestors[0]);
 //                }
 //
 //                DataType get_data_type() const {
@@ -87,16 +69,16 @@ namespace md {
             public:
                 std::vector<bool> div;
                 Mul(GraphInPtr graph, NodeVec parents, std::vector<bool> div) :
-                        AbstractOperator(graph, "Mul"), AssociativeOperator(parents),
+                        AbstractOperator(graph, OpKind::Mul), AssociativeOperator(parents),
                         div(div){};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Mul>(graph, ancestors, div);
+                    return make_operator<Mul>(graph, ancestors, div);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index){
                     if (parents.size() == 2 and not div[index]) {
-                        return parents[1-index];
+                        return mul({my_derivative, parents[1-index]}, {false, div[1-index]});
                     } else {
                         auto factor = mul({result, my_derivative, parents[index]}, {false, false, true});
                         return div[index] ? (- factor) : factor;
@@ -107,41 +89,23 @@ namespace md {
                     return backward_diff_parent(parent_derivatives[index], index);
                 }
 
-//                bool equals(Operator const op) const {
-//                    if (name == op->name) {
-//                        bool check[parents.size()];
-//                        for (int i = 0; i < parents.size(); i++) {
-//                            check[i] = false;
-//                        }
-//                        if (parents.size() != op->get_parents().size()) {
-//                            return false;
-//                        }
-//                        for (int i = 0; i < parents.size(); i++) {
-//                            Node parent = op->get_parents()[i];
-//                            int j = 0;
-//                            for (; j < parents.size(); j++) {
-//                                if (symbolic_equals(parent, parents[j]) and not check[j]) {
-//                                    check[j] = true;
-//                                    break;
-//                                }
-//                            }
-//                            if (j == parents.size()) {
-//                                return false;
-//                            }
-//                        }
-//                    }
-//                    return false;
-//                }
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const Mul>(op);
+                        return div == cast_op->div;
+                    }
+                    return false;
+                }
             };
 
 //            /** Elementwise inverse (division) */
 //            class Division : public FloatUnaryElementwiseOperator {
 //            public:
 //                Division(GraphInPtr graph, Node parent) :
-//                        AbstractOperator(graph, "Division"), UnaryOperator(parent) {};
+//                        AbstractOperator(graph, OpKind::Division), UnaryOperator(parent) {};
 //
 //                Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-//                    return std::make_shared<Division>(graph, ancestors[0]);
+//                    return make_operator<Division>(graph, ancestors[0]);
 //                }
 //
 //                Node backward_diff_parent(Node my_derivative, int index){
@@ -153,10 +117,14 @@ namespace md {
             class IntDiv : public BinaryIntegerElementwiseOperator{
             public:
                 IntDiv(GraphInPtr graph, Node parent1, Node parent2) :
-                        AbstractOperator(graph, "IntDiv"), BinaryOperator(parent1, parent2){};
+                        AbstractOperator(graph, OpKind::IntDiv), BinaryOperator(parent1, parent2){};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<IntDiv>(graph, ancestors[0], ancestors[1]);
+                    return make_operator<IntDiv>(graph, ancestors[0], ancestors[1]);
+                }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
                 }
             };
 
@@ -164,10 +132,14 @@ namespace md {
             class IntMod : public BinaryIntegerElementwiseOperator {
             public:
                 IntMod(GraphInPtr graph, Node parent1, Node parent2) :
-                        AbstractOperator(graph, "IntMod"), BinaryOperator(parent1, parent2){};
+                        AbstractOperator(graph, OpKind::IntMod), BinaryOperator(parent1, parent2){};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<IntMod>(graph, ancestors[0], ancestors[1]);
+                    return make_operator<IntMod>(graph, ancestors[0], ancestors[1]);
+                }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
                 }
             };
         }
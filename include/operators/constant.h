@@ -17,25 +17,29 @@ namespace md {
                               double value,
                               DataType data_type,
                               Shape shape) :
-                        AbstractOperator(graph, "ConstantValue"), ConstantOperator(data_type),
+                        AbstractOperator(graph, OpKind::ConstantValue), ConstantOperator(data_type),
                         shape(shape), value(value) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<ConstantValue>(graph, value, data_type, shape);
+                    return make_operator<ConstantValue>(graph, value, data_type, shape);
                 }
 
                 Shape get_shape() const {
                     return shape;
                 }
 
-//                bool equals(Operator const op) const {
-//                    if (name == op->name) {
-//                        auto cast_op = std::static_pointer_cast<const ConstantValue>(op);
-//                        return shape == cast_op->shape and data_type == cast_op->data_type and
-//                               value == cast_op->value;
-//                    }
-//                    return false;
-//                }
+                size_t hash() const {
+                    size_t seed = AbstractOperator::hash();
+                    return seed ^ (std::hash<double>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+                }
+
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const ConstantValue>(op);
+                        return value == cast_op->value and data_type == cast_op->data_type and shape == cast_op->shape;
+                    }
+                    return false;
+                }
             };
 
             /** Wrapper arround a SymInt */
@@ -44,24 +48,24 @@ namespace md {
                 SymInt value;
 
                 SymIntWrapper(GraphInPtr graph, SymInt value) :
-                        AbstractOperator(graph, "SymIntWrapper"), ConstantOperator(DataType(UNSIGNED_INT, graph->props.max_int)),
+                        AbstractOperator(graph, OpKind::SymIntWrapper), ConstantOperator(DataType(UNSIGNED_INT, graph->props.max_int)),
                         value(value) {}
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<SymIntWrapper>(graph, value);
+                    return make_operator<SymIntWrapper>(graph, value);
                 }
 
                 Shape get_shape() const {
                     return Shape{1, 1, 1, 1};
                 }
 
-//                bool equals(Operator const op) const {
-//                    if (this->name == op->name) {
-//                        auto cast_op = std::static_pointer_cast<const SymIntWrapper>(op);
-//                        return cast_op->value == value;
-//                    }
-//                    return false;
-//                }
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const SymIntWrapper>(op);
+                        return value == cast_op->value;
+                    }
+                    return false;
+                }
             };
 
             /** A vector of the sequence from 'start' to 'end' */
@@ -71,25 +75,24 @@ namespace md {
                 SymInt end;
 
                 Range(GraphInPtr graph, SymInt start, SymInt end, DataType data_type) :
-                        AbstractOperator(graph, "Range"), ConstantOperator(data_type),
+                        AbstractOperator(graph, OpKind::Range), ConstantOperator(data_type),
                         start(start), end(end) {}
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Range>(graph, start, end, data_type);
+                    return make_operator<Range>(graph, start, end, data_type);
                 }
 
                 Shape get_shape() const {
                     return {end - start, 1, 1, 1};
                 }
 
-//                bool equals(Operator const op) const {
-//                    if (ConstantOperator::equals(op)) {
-//                        auto cast_op = std::static_pointer_cast<const Range>(op);
-//                        return start == cast_op->start and end == cast_op->end;
-//                    } else {
-//                        return false;
-//                    }
-//                }
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const Range>(op);
+                        return start == cast_op->start and end == cast_op->end and data_type == cast_op->data_type;
+                    }
+                    return false;
+                }
             };
 
             /** Matrix identity */
@@ -97,24 +100,24 @@ namespace md {
             public:
                 SymInt size;
                 Eye(GraphInPtr graph, SymInt size, DataType data_type) :
-                        AbstractOperator(graph, "Eye"),  ConstantOperator(data_type),
+                        AbstractOperator(graph, OpKind::Eye),  ConstantOperator(data_type),
                         size(size){}
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Eye>(graph, size, data_type);
+                    return make_operator<Eye>(graph, size, data_type);
                 }
 
                 Shape get_shape() const {
                     return {size, size, 1, 1};
                 }
 
-//                bool equals(Operator const op) const {
-//                    if (name == op->name) {
-//                        auto cast_op = std::static_pointer_cast<const Eye>(op);
-//                        return size == cast_op->size;
-//                    }
-//                    return false;
-//                }
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const Eye>(op);
+                        return size == cast_op->size and data_type == cast_op->data_type;
+                    }
+                    return false;
+                }
             };
         }
     }
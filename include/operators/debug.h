@@ -12,10 +12,10 @@ namespace md{
             class Print: public MonitorOperator{
             public:
                 Print(GraphInPtr const graph, Node anchor, Node monitored, std::string msg):
-                        AbstractOperator(graph, "Print"), UnaryOperator(anchor), MonitorOperator(monitored, msg) {};
+                        AbstractOperator(graph, OpKind::Print), UnaryOperator(anchor), MonitorOperator(monitored, msg) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Print>(graph, ancestors[0], ancestors[1], msg);
+                    return make_operator<Print>(graph, ancestors[0], ancestors[1], msg);
                 }
             };
 
@@ -23,10 +23,10 @@ namespace md{
             class Retrieve: public MonitorOperator{
             public:
                 Retrieve(GraphInPtr const graph, Node anchor, Node monitored, std::string msg):
-                        AbstractOperator(graph, "Retrieve"), UnaryOperator(anchor), MonitorOperator(monitored, msg) {};
+                        AbstractOperator(graph, OpKind::Retrieve), UnaryOperator(anchor), MonitorOperator(monitored, msg) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Retrieve>(graph, ancestors[0], ancestors[1], msg);
+                    return make_operator<Retrieve>(graph, ancestors[0], ancestors[1], msg);
                 }
             };
 
@@ -34,10 +34,10 @@ namespace md{
             class LogToFile: public MonitorOperator{
             public:
                 LogToFile(GraphInPtr const graph, Node anchor, Node monitored, std::string msg):
-                        AbstractOperator(graph, "LogToFile"), UnaryOperator(anchor), MonitorOperator(monitored, msg) {};
+                        AbstractOperator(graph, OpKind::LogToFile), UnaryOperator(anchor), MonitorOperator(monitored, msg) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<LogToFile>(graph, ancestors[0], ancestors[1], msg);
+                    return make_operator<LogToFile>(graph, ancestors[0], ancestors[1], msg);
                 }
             };
 
@@ -47,11 +47,11 @@ namespace md{
                 double low;
                 double high;
                 Guard(GraphInPtr const graph, Node anchor, Node monitored, std::string msg, double low, double high):
-                        AbstractOperator(graph, "Guard"), UnaryOperator(anchor), MonitorOperator(monitored, msg),
+                        AbstractOperator(graph, OpKind::Guard), UnaryOperator(anchor), MonitorOperator(monitored, msg),
                         low(low), high(high){};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Guard>(graph, ancestors[0], ancestors[1], msg, low, high);
+                    return make_operator<Guard>(graph, ancestors[0], ancestors[1], msg, low, high);
                 }
             };
         }
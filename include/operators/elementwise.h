@@ -13,10 +13,10 @@ namespace md{
             class Abs : public MorphElementwiseOperator {
             public:
                 Abs(GraphInPtr graph, Node parent) :
-                        AbstractOperator(graph, "Abs"), UnaryOperator(parent) {};
+                        AbstractOperator(graph, OpKind::Abs), UnaryOperator(parent) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Abs>(graph, ancestors[0]);
+                    return make_operator<Abs>(graph, ancestors[0]);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index){
@@ -29,83 +29,107 @@ namespace md{
                 Node forward_diff_parent(NodeVec & parent_derivatives, int index){
                     return backward_diff_parent(parent_derivatives[index], index);
                 }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
 
             /** Squre */
             class Square : public FloatUnaryElementwiseOperator {
             public:
                 Square(GraphInPtr graph, Node parent) :
-                AbstractOperator(graph, "Square"), UnaryOperator(parent) {};
+                AbstractOperator(graph, OpKind::Square), UnaryOperator(parent) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Square>(graph, ancestors[0]);
+                    return make_operator<Square>(graph, ancestors[0]);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index) {
                     Node two = graph->constant(2);
                     return mul(my_derivative, two, parent);
                 }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
 
             /** Square root */
             class Sqrt : public FloatUnaryElementwiseOperator {
             public:
                 Sqrt(GraphInPtr graph, Node parent) :
-                        AbstractOperator(graph, "Sqrt"), UnaryOperator(parent) {};
+                        AbstractOperator(graph, OpKind::Sqrt), UnaryOperator(parent) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Sqrt>(graph, ancestors[0]);
+                    return make_operator<Sqrt>(graph, ancestors[0]);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index) {
                     Node two = graph->constant(2);
                     return div(my_derivative, mul(two, result));
                 }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
 
             /** Exponential */
             class Exp : public FloatUnaryElementwiseOperator {
             public:
                 Exp(GraphInPtr graph, Node parent) :
-                        AbstractOperator(graph, "Exp"), UnaryOperator(parent) {};
+                        AbstractOperator(graph, OpKind::Exp), UnaryOperator(parent) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Exp>(graph, ancestors[0]);
+                    return make_operator<Exp>(graph, ancestors[0]);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index) {
                     return mul(my_derivative, result);
                 }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
 
             /** Logarithm */
             class Log : public FloatUnaryElementwiseOperator {
             public:
                 Log(GraphInPtr graph, Node parent) :
-                        AbstractOperator(graph, "Log"), UnaryOperator(parent) {};
+                        AbstractOperator(graph, OpKind::Log), UnaryOperator(parent) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Log>(graph, ancestors[0]);
+                    return make_operator<Log>(graph, ancestors[0]);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index) {
                     return div(my_derivative, parent);
                 }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
 
             /** Logarithm in base 10 */
             class Log10 : public FloatUnaryElementwiseOperator {
             public:
                 Log10(GraphInPtr graph, Node parent) :
-                        AbstractOperator(graph, "Log10"), UnaryOperator(parent) {};
+                        AbstractOperator(graph, OpKind::Log10), UnaryOperator(parent) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Log>(graph, ancestors[0]);
+                    return make_operator<Log>(graph, ancestors[0]);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index) {
                     return div(my_derivative, mul(parent, graph->LN_10()));
                 }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
 
             /** Logarithm of x + 1 */
@@ -113,131 +137,164 @@ namespace md{
             public:
                 Log1p(GraphInPtr graph,
                       Node parent) :
-                        AbstractOperator(graph, "Log1p"), UnaryOperator(parent) {};
+                        AbstractOperator(graph, OpKind::Log1p), UnaryOperator(parent) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Log1p>(graph, ancestors[0]);
+                    return make_operator<Log1p>(graph, ancestors[0]);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index) {
                     return mul(my_derivative, sigmoid(parent));
                 }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
 
             /** Trigonometric sine */
             class Sin : public FloatUnaryElementwiseOperator {
             public:
                 Sin(GraphInPtr graph, Node parent) :
-                        AbstractOperator(graph, "Sin"), UnaryOperator(parent) {};
+                        AbstractOperator(graph, OpKind::Sin), UnaryOperator(parent) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Sin>(graph, ancestors[0]);
+                    return make_operator<Sin>(graph, ancestors[0]);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index) {
                     return my_derivative * cos(parent);
                 }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
 
             /** Trigonometric cosine */
             class Cos : public FloatUnaryElementwiseOperator {
             public:
                 Cos(GraphInPtr graph, Node parent) :
-                        AbstractOperator(graph, "Cos"), UnaryOperator(parent) {};
+                        AbstractOperator(graph, OpKind::Cos), UnaryOperator(parent) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Cos>(graph, ancestors[0]);
+                    return make_operator<Cos>(graph, ancestors[0]);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index) {
                     return mul(my_derivative, neg(sin(parent)));
                 }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
 
             /** Trigonometric tangent */
             class Tan : public FloatUnaryElementwiseOperator {
             public:
                 Tan(GraphInPtr graph, Node parent) :
-                        AbstractOperator(graph, "Tan"), UnaryOperator(parent) {};
+                        AbstractOperator(graph, OpKind::Tan), UnaryOperator(parent) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Tan>(graph, ancestors[0]);
+                    return make_operator<Tan>(graph, ancestors[0]);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index) {
                     return div(my_derivative, square(cos(parent)));
                 }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
 
             /** Trigonometric cotangent */
             class Cot : public FloatUnaryElementwiseOperator {
             public:
                 Cot(GraphInPtr graph, Node parent) :
-                        AbstractOperator(graph, "Cot"), UnaryOperator(parent) {};
+                        AbstractOperator(graph, OpKind::Cot), UnaryOperator(parent) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Cot>(graph, ancestors[0]);
+                    return make_operator<Cot>(graph, ancestors[0]);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index) {
                     return neg(div(my_derivative, square(sin(parent))));
                 }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
 
             /** Hyperbolic sine */
             class Sinh : public FloatUnaryElementwiseOperator {
             public:
                 Sinh(GraphInPtr graph, Node parent) :
-                        AbstractOperator(graph, "Sinh"), UnaryOperator(parent) {};
+                        AbstractOperator(graph, OpKind::Sinh), UnaryOperator(parent) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Sinh>(graph, ancestors[0]);
+                    return make_operator<Sinh>(graph, ancestors[0]);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index) {
                     return mul(my_derivative, cosh(parent));
                 }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
 
             /** Hyperbolic cosine */
             class Cosh : public FloatUnaryElementwiseOperator {
             public:
                 Cosh(GraphInPtr graph, Node parent) :
-                        AbstractOperator(graph, "Cosh"), UnaryOperator(parent) {};
+                        AbstractOperator(graph, OpKind::Cosh), UnaryOperator(parent) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Cosh>(graph, ancestors[0]);
+                    return make_operator<Cosh>(graph, ancestors[0]);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index) {
                     return mul(my_derivative, sinh(parent));
                 }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
 
             /** Hyperbolic tangent */
             class Tanh : public FloatUnaryElementwiseOperator {
             public:
                 Tanh(GraphInPtr graph, Node parent) :
-                        AbstractOperator(graph, "Tanh"), UnaryOperator(parent) {};
+                        AbstractOperator(graph, OpKind::Tanh), UnaryOperator(parent) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Tanh>(graph, ancestors[0]);
+                    return make_operator<Tanh>(graph, ancestors[0]);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index) {
-                    Node derivative = neg(graph->constant(1), square(result));
+                    // The square goes first, such that the derivative has its shape rather than of the constant
+                    Node derivative = add({square(result), graph->constant(1)}, {true, false});
                     return mul(my_derivative, derivative);
                 }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
 
             /** Hyperbolic cotangent */
             class Coth : public FloatUnaryElementwiseOperator {
             public:
                 Coth(GraphInPtr graph, Node parent) :
-                        AbstractOperator(graph, "Coth"), UnaryOperator(parent) {};
+                        AbstractOperator(graph, OpKind::Coth), UnaryOperator(parent) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Coth>(graph, ancestors[0]);
+                    return make_operator<Coth>(graph, ancestors[0]);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index) {
@@ -245,16 +302,20 @@ namespace md{
                     Node derivative = neg(one, square(result));
                     return mul(my_derivative, derivative);
                 }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
 
             /** Takes the first input to the power of the second elementwise */
             class Pow : public BinaryFloatElementwiseOperator {
             public:
                 Pow(GraphInPtr graph, Node parent1, Node parent2) :
-                        AbstractOperator(graph, "Pow"), BinaryOperator(parent1, parent2) {};
+                        AbstractOperator(graph, OpKind::Pow), BinaryOperator(parent1, parent2) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Pow>(graph, ancestors[0], ancestors[1]);
+                    return make_operator<Pow>(graph, ancestors[0], ancestors[1]);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index){
@@ -266,6 +327,10 @@ namespace md{
                         return mul(product, log(parent1));
                     }
                 }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
         }
     }
@@ -16,11 +16,11 @@ namespace md {
 
                 Slice(GraphInPtr graph, Node parent,
                       Axes axes, std::vector <std::pair<SymInt, SymInt>> slices) :
-                        AbstractOperator(graph, "Slice"), UnaryOperator(parent),
+                        AbstractOperator(graph, OpKind::Slice), UnaryOperator(parent),
                         axes(axes), slices(slices) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Slice>(graph, ancestors[0], axes, slices);
+                    return make_operator<Slice>(graph, ancestors[0], axes, slices);
                 }
 
                 Shape get_shape() const {
@@ -38,6 +38,14 @@ namespace md {
                 Node forward_diff_parent(NodeVec& parent_derivatives, int index){
                     return api::slice(parent_derivatives[index], axes, slices);
                 }
+
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const Slice>(op);
+                        return axes == cast_op->axes and slices == cast_op->slices;
+                    }
+                    return false;
+                }
             };
 
             /** Trying standard indexing */
@@ -48,13 +56,13 @@ namespace md {
 
                 Index(GraphInPtr graph, Node parent,
                       Axes axes, NodeVec indexes) :
-                        AbstractOperator(graph, "Index"), UnaryOperator(parent),
+                        AbstractOperator(graph, OpKind::Index), UnaryOperator(parent),
                         axes(axes), indexes(indexes) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
                     Node parent = ancestors[0];
                     ancestors.erase(ancestors.begin());
-                    return std::make_shared<Index>(graph, parent, axes, ancestors);
+                    return make_operator<Index>(graph, parent, axes, ancestors);
                 }
 
                 NodeVec get_arguments() const {
@@ -92,6 +100,14 @@ namespace md {
                 Node forward_diff_parent(NodeVec& parent_derivatives, int index){
                     return api::index(parent_derivatives[index], axes, indexes);
                 }
+
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const Index>(op);
+                        return axes == cast_op->axes;
+                    }
+                    return false;
+                }
             };
 
 //            bool equals(const std::shared_ptr<Operator> op) const {
@@ -138,7 +154,7 @@ namespace md {
 //            }
 //
 //            std::shared_ptr<Operator> copy_to(GraphInPtr graph, std::vector<Node> ancestors) const {
-//                return std::make_shared<SliceGrad>(graph, ancestors[0], ancestors[1], axis, result);
+//                return make_operator<SliceGrad>(graph, ancestors[0], ancestors[1], axis, result);
 //            }
 //
 //            bool equals(const std::shared_ptr<Operator> op) const {
@@ -156,11 +172,11 @@ namespace md {
 //
 //        Node Slice::backward_diff(Node my_grad, size_t index) {
 //            return graph->derived_node(
-//                    std::make_shared<SliceGrad>(graph, my_grad, this->index, axis, result.unwrap()->shape));
+//                    make_operator<SliceGrad>(graph, my_grad, this->index, axis, result.unwrap()->shape));
 //        }
 //
 //        Node SliceGrad::backward_diff(Node my_grad, size_t index) {
-//            return graph->derived_node(std::make_shared<Slice>(graph, my_grad, this->index, axis));
+//            return graph->derived_node(make_operator<Slice>(graph, my_grad, this->index, axis));
 //        }
 //
 //        Node Node::slice(Node index, size_t axis) {
@@ -191,7 +207,7 @@ namespace md {
 //            };
 //
 //            std::shared_ptr<Operator> copy_to(GraphInPtr graph, std::vector<Node> ancestors) const {
-//                return std::make_shared<Index>(graph, ancestors[0], ancestors[1], axis);
+//                return make_operator<Index>(graph, ancestors[0], ancestors[1], axis);
 //            }
 //
 //            Shape get_shape() const {
@@ -237,7 +253,7 @@ namespace md {
 //            };
 //
 //            std::shared_ptr<Operator> copy_to(GraphInPtr graph, std::vector<Node> ancestors) const {
-//                return std::make_shared<IndexGrad>(graph, ancestors[0], ancestors[1], axis, result);
+//                return make_operator<IndexGrad>(graph, ancestors[0], ancestors[1], axis, result);
 //            }
 //
 //            Shape get_shape() const {
@@ -264,11 +280,11 @@ namespace md {
 //
 //        Node Index::backward_diff(Node my_grad, size_t index) {
 //            return graph->derived_node(
-//                    std::make_shared<IndexGrad>(graph, my_grad, this->index, axis, result.unwrap()->shape[axis]));
+//                    make_operator<IndexGrad>(graph, my_grad, this->index, axis, result.unwrap()->shape[axis]));
 //        }
 //
 //        Node IndexGrad::backward_diff(Node my_grad, size_t index) {
-//            return graph->derived_node(std::make_shared<Index>(graph, my_grad, this->index, axis));
+//            return graph->derived_node(make_operator<Index>(graph, my_grad, this->index, axis));
 //        }
 //
 //        Node Node::index(Node index, size_t axis) {
@@ -15,11 +15,11 @@ namespace md {
                 Shape shape;
 
                 Input(GraphInPtr graph, DataType data_type, Shape shape) :
-                        AbstractOperator(graph, "Input"),
+                        AbstractOperator(graph, OpKind::Input),
                         data_type(data_type), shape(shape) {}
 
                 Operator copy_to(GraphInPtr graph, std::vector<Node> ancestors) const {
-                    return std::make_shared<Input>(graph, data_type, shape);
+                    return make_operator<Input>(graph, data_type, shape);
                 }
 
                 DataType get_data_type() const {
@@ -40,11 +40,11 @@ namespace md {
 
 
                 Parameter(GraphInPtr graph, std::string full_name, DataType data_type, Shape shape) :
-                        AbstractOperator(graph, "Parameter"),
+                        AbstractOperator(graph, OpKind::Parameter),
                         full_name(full_name), data_type(data_type), shape(shape) {}
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Parameter>(graph, full_name, data_type, shape);
+                    return make_operator<Parameter>(graph, full_name, data_type, shape);
                 }
 
                 DataType get_data_type() const {
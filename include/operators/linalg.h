@@ -15,11 +15,11 @@ namespace md{
                 MatrixMul(GraphInPtr graph,
                           NodeVec parents,
                           std::vector<bool> t) :
-                        AbstractOperator(graph, "MatrixMul"), AssociativeOperator(parents),
+                        AbstractOperator(graph, OpKind::MatrixMul), AssociativeOperator(parents),
                         t(t){}
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<MatrixMul>(graph, ancestors, t);
+                    return make_operator<MatrixMul>(graph, ancestors, t);
                 }
 
                 Shape get_shape() const{
@@ -74,20 +74,13 @@ namespace md{
                     return matrix_mul(product, t);
                 }
 
-//                bool equals(Operator const op) const {
-//                    if (name == op->name) {
-//                        if (parents.size() != op->get_parents().size()) {
-//                            return false;
-//                        }
-//                        for (int i = 0; i < parents.size(); i++) {
-//                            if (not symbolic_equals(parents[i], op->get_parents()[i])) {
-//                                return false;
-//                            }
-//                        }
-//                        return true;
-//                    }
-//                    return false;
-//                }
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const MatrixMul>(op);
+                        return t == cast_op->t;
+                    }
+                    return false;
+                }
             };
 
             /** MatrixInverse */
@@ -95,7 +88,7 @@ namespace md{
             public:
                 bool t;
                 MatrixInverse(GraphInPtr graph, Node parent, bool t) :
-                        AbstractOperator(graph, "MatrixInverse"), UnaryOperator(parent),
+                        AbstractOperator(graph, OpKind::MatrixInverse), UnaryOperator(parent),
                         t(t){}
 
                 Shape get_shape() const {
@@ -103,7 +96,7 @@ namespace md{
                 }
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<MatrixInverse>(graph, ancestors[0], t);
+                    return make_operator<MatrixInverse>(graph, ancestors[0], t);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index) {
@@ -113,6 +106,14 @@ namespace md{
                 Node forward_diff_parent(NodeVec & parent_derivatives, int index){
                     return - matrix_mul({result, parent_derivatives[index], result}, {false, t, false});
                 }
+
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const MatrixInverse>(op);
+                        return t == cast_op->t;
+                    }
+                    return false;
+                }
             };
 
             /** MatrixInverse times a second matrix - the same as solving the linear system */
@@ -121,11 +122,11 @@ namespace md{
                 bool t_inv;
                 bool t_mul;
                 MatrixInverseMul(GraphInPtr graph, Node parent1, Node parent2, bool t_inv, bool t_mul) :
-                        AbstractOperator(graph, "MatrixInverseMul"), BinaryOperator(parent1, parent2),
+                        AbstractOperator(graph, OpKind::MatrixInverseMul), BinaryOperator(parent1, parent2),
                         t_inv(t_inv), t_mul(t_mul){}
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<MatrixInverseMul>(graph, ancestors[0], ancestors[1], t_inv, t_mul);
+                    return make_operator<MatrixInverseMul>(graph, ancestors[0], ancestors[1], t_inv, t_mul);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index) {
@@ -146,8 +147,8 @@ namespace md{
                 }
 
                 Node forward_diff_parent(NodeVec & parent_derivatives, int index){
-                    if(not parent_derivatives[0].ptr.expired() and
-                       not parent_derivatives[1].ptr.expired()){
+                    if(not parent_derivatives[0].empty() and
+                       not parent_derivatives[1].empty()){
                         if(index == 0){
                             Node p1;
                             if(t_mul){
@@ -166,16 +167,24 @@ namespace md{
                         return matrix_inverse_mul(parent1, parent_derivatives[index], t_inv, t_mul);
                     }
                 }
+
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const MatrixInverseMul>(op);
+                        return t_inv == cast_op->t_inv and t_mul == cast_op->t_mul;
+                    }
+                    return false;
+                }
             };
 
             /** Kronecker product */
             class Kronecker: public BinaryOperator, public FloatOperator {
             public:
                 Kronecker(GraphInPtr graph, Node parent1, Node parent2) :
-                        AbstractOperator(graph, "Kronecker"), BinaryOperator(parent1, parent2) {}
+                        AbstractOperator(graph, OpKind::Kronecker), BinaryOperator(parent1, parent2) {}
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Kronecker>(graph, ancestors[0], ancestors[1]);
+                    return make_operator<Kronecker>(graph, ancestors[0], ancestors[1]);
                 }
 
                 Shape get_shape() const {
@@ -195,16 +204,19 @@ namespace md{
                     }
                 }
 
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
 
             /** Determinant of a square matrix */
             class Determinant : public FloatUnaryOperator {
             public:
                 Determinant(GraphInPtr graph, Node parent) :
-                        AbstractOperator(graph, "Determinant"), UnaryOperator(parent) {}
+                        AbstractOperator(graph, OpKind::Determinant), UnaryOperator(parent) {}
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Determinant>(graph, ancestors[0]);
+                    return make_operator<Determinant>(graph, ancestors[0]);
                 }
 
                 Shape get_shape() const {
@@ -220,16 +232,19 @@ namespace md{
                     return result * tr;
                 }
 
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
 
             /** The natural logarithm of the determinant a square matrix */
             class LogDeterminant : public FloatUnaryOperator {
             public:
                 LogDeterminant(GraphInPtr graph, Node parent) :
-                        AbstractOperator(graph, "LogDeterminant"), UnaryOperator(parent) {}
+                        AbstractOperator(graph, OpKind::LogDeterminant), UnaryOperator(parent) {}
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<LogDeterminant>(graph, ancestors[0]);
+                    return make_operator<LogDeterminant>(graph, ancestors[0]);
                 }
 
                 Shape get_shape() const {
@@ -244,16 +259,19 @@ namespace md{
                     return trace(matrix_inverse_mul(parent, parent_derivatives[index]));
                 }
 
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
 
             /** The trace  of a square matrix */
             class Trace : public MorphOperator {
             public:
                 Trace(GraphInPtr graph, Node parent) :
-                        AbstractOperator(graph, "Trace"), UnaryOperator(parent) {}
+                        AbstractOperator(graph, OpKind::Trace), UnaryOperator(parent) {}
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Trace>(graph, ancestors[0]);
+                    return make_operator<Trace>(graph, ancestors[0]);
                 }
 
                 Shape get_shape() const {
@@ -267,6 +285,10 @@ namespace md{
                 Node forward_diff_parent(NodeVec & parent_derivatives, int index){
                     return trace(parent_derivatives[index]);
                 }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
 
 
@@ -275,11 +297,11 @@ namespace md{
             public:
                 bool lower;
                 CholeskyForwardDiff(GraphInPtr graph, Node cholesky, Node parent_derivative, bool lower) :
-                        AbstractOperator(graph, "CholeskyForwardDiff"), BinaryOperator(cholesky, parent_derivative),
+                        AbstractOperator(graph, OpKind::CholeskyForwardDiff), BinaryOperator(cholesky, parent_derivative),
                         lower(lower) {}
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<CholeskyForwardDiff>(graph, ancestors[0], ancestors[1], lower);
+                    return make_operator<CholeskyForwardDiff>(graph, ancestors[0], ancestors[1], lower);
                 }
 
                 Shape get_shape() const {
@@ -293,6 +315,14 @@ namespace md{
                 Node forward_diff_parent(NodeVec & parent_derivatives, int index){
                     throw NotImplementedError(__LINE__, __FILE__);
                 }
+
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const CholeskyForwardDiff>(op);
+                        return lower == cast_op->lower;
+                    }
+                    return false;
+                }
             };
 
             /** A special operator for the cholesky forward diff */
@@ -300,11 +330,11 @@ namespace md{
             public:
                 bool lower;
                 CholeskyBackwardDiff(GraphInPtr graph, Node cholesky, Node parent_derivative, bool lower) :
-                        AbstractOperator(graph, "CholeskyBackwardDiff"), BinaryOperator(cholesky, parent_derivative),
+                        AbstractOperator(graph, OpKind::CholeskyBackwardDiff), BinaryOperator(cholesky, parent_derivative),
                         lower(lower) {}
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<CholeskyBackwardDiff>(graph, ancestors[0], ancestors[1], lower);
+                    return make_operator<CholeskyBackwardDiff>(graph, ancestors[0], ancestors[1], lower);
                 }
 
                 Shape get_shape() const {
@@ -318,6 +348,14 @@ namespace md{
                 Node forward_diff_parent(NodeVec & parent_derivatives, int index){
                     throw NotImplementedError(__LINE__, __FILE__);
                 }
+
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const CholeskyBackwardDiff>(op);
+                        return lower == cast_op->lower;
+                    }
+                    return false;
+                }
             };
 
             /** Returns the Cholesky decomposition of the input */
@@ -325,11 +363,11 @@ namespace md{
             public:
                 bool lower;
                 Cholesky(GraphInPtr graph, Node parent, bool lower) :
-                        AbstractOperator(graph, "Cholesky"), UnaryOperator(parent),
+                        AbstractOperator(graph, OpKind::Cholesky), UnaryOperator(parent),
                         lower(lower) {}
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Cholesky>(graph, ancestors[0], lower);
+                    return make_operator<Cholesky>(graph, ancestors[0], lower);
                 }
 
                 Shape get_shape() const {
@@ -337,24 +375,32 @@ namespace md{
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index) {
-                    auto op = std::make_shared<CholeskyBackwardDiff>(graph, result, my_derivative, lower);
+                    auto op = make_operator<CholeskyBackwardDiff>(graph, result, my_derivative, lower);
                     return graph->derived_node(op);
                 }
 
                 Node forward_diff_parent(NodeVec & parent_derivatives, int index){
-                    auto op = std::make_shared<CholeskyForwardDiff>(graph, result, parent_derivatives[index], lower);
+                    auto op = make_operator<CholeskyForwardDiff>(graph, result, parent_derivatives[index], lower);
                     return graph->derived_node(op);
                 }
+
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const Cholesky>(op);
+                        return lower == cast_op->lower;
+                    }
+                    return false;
+                }
             };
 
             /** Returns the packed LU decomposition */
             class LU : public FloatUnaryOperator {
             public:
                 LU(GraphInPtr graph, Node parent) :
-                        AbstractOperator(graph, "LU"), UnaryOperator(parent) {}
+                        AbstractOperator(graph, OpKind::LU), UnaryOperator(parent) {}
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<LU>(graph, ancestors[0]);
+                    return make_operator<LU>(graph, ancestors[0]);
                 }
 
                 Shape get_shape() const {
@@ -370,16 +416,20 @@ namespace md{
                     // TODO
                     throw NotImplementedError(__LINE__, __FILE__);
                 }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
 
             /** Returns the packed QR decomposition */
             class QR : public MultiOutputOperator {
             public:
                 QR(GraphInPtr graph, Node parent) :
-                        AbstractOperator(graph, "QR"), MultiOutputOperator(2) {}
+                        AbstractOperator(graph, OpKind::QR), MultiOutputOperator(2) {}
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<QR>(graph, ancestors[0]);
+                    return make_operator<QR>(graph, ancestors[0]);
                 }
 
                 Shape get_shape() const {
@@ -421,10 +471,10 @@ namespace md{
             class SVD : public MultiOutputOperator {
             public:
                 SVD(GraphInPtr graph, Node parent) :
-                        AbstractOperator(graph, "SVD"), MultiOutputOperator(3) {}
+                        AbstractOperator(graph, OpKind::SVD), MultiOutputOperator(3) {}
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<SVD>(graph, ancestors[0]);
+                    return make_operator<SVD>(graph, ancestors[0]);
                 }
 
                 Shape get_shape() const {
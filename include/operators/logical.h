@@ -13,10 +13,14 @@ namespace md {
             class LogicalNot : public LogicalUnaryElementwise {
             public:
                 LogicalNot(GraphInPtr graph, Node parent) :
-                        AbstractOperator(graph, "LogicalNot"), UnaryOperator(parent) {}
+                        AbstractOperator(graph, OpKind::LogicalNot), UnaryOperator(parent) {}
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<LogicalNot>(graph, ancestors[0]);
+                    return make_operator<LogicalNot>(graph, ancestors[0]);
+                }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
                 }
             };
 
@@ -26,10 +30,14 @@ namespace md {
                 LogicalAnd(GraphInPtr graph,
                            Node parent1,
                            Node parent2) :
-                        AbstractOperator(graph, "LogicalAnd"), BinaryOperator(parent1, parent2) {};
+                        AbstractOperator(graph, OpKind::LogicalAnd), BinaryOperator(parent1, parent2) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<LogicalAnd>(graph, ancestors[0], ancestors[1]);
+                    return make_operator<LogicalAnd>(graph, ancestors[0], ancestors[1]);
+                }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
                 }
             };
 
@@ -39,10 +47,14 @@ namespace md {
                 LogicalOr(GraphInPtr graph,
                           Node parent1,
                           Node parent2) :
-                        AbstractOperator(graph, "LogicalOr"), BinaryOperator(parent1, parent2) {};
+                        AbstractOperator(graph, OpKind::LogicalOr), BinaryOperator(parent1, parent2) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<LogicalOr>(graph, ancestors[0], ancestors[1]);
+                    return make_operator<LogicalOr>(graph, ancestors[0], ancestors[1]);
+                }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
                 }
             };
 
@@ -52,10 +64,14 @@ namespace md {
                 GreaterThan(GraphInPtr graph,
                             Node parent1,
                             Node parent2) :
-                        AbstractOperator(graph, "GreaterThan"), BinaryOperator(parent1, parent2) {};
+                        AbstractOperator(graph, OpKind::GreaterThan), BinaryOperator(parent1, parent2) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<GreaterThan>(graph, ancestors[0], ancestors[1]);
+                    return make_operator<GreaterThan>(graph, ancestors[0], ancestors[1]);
+                }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
                 }
             };
 
@@ -65,10 +81,14 @@ namespace md {
                 LessThan(GraphInPtr graph,
                          Node parent1,
                          Node parent2) :
-                        AbstractOperator(graph, "LessThan"), BinaryOperator(parent1, parent2) {};
+                        AbstractOperator(graph, OpKind::LessThan), BinaryOperator(parent1, parent2) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<LessThan>(graph, ancestors[0], ancestors[1]);
+                    return make_operator<LessThan>(graph, ancestors[0], ancestors[1]);
+                }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
                 }
             };
 
@@ -78,10 +98,14 @@ namespace md {
                 GreaterThanOrEqual(GraphInPtr graph,
                                    Node parent1,
                                    Node parent2) :
-                        AbstractOperator(graph, "GreaterThanOrEqual"), BinaryOperator(parent1, parent2) {};
+                        AbstractOperator(graph, OpKind::GreaterThanOrEqual), BinaryOperator(parent1, parent2) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<GreaterThanOrEqual>(graph, ancestors[0], ancestors[1]);
+                    return make_operator<GreaterThanOrEqual>(graph, ancestors[0], ancestors[1]);
+                }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
                 }
             };
 
@@ -91,10 +115,14 @@ namespace md {
                 LessThanOrEqual(GraphInPtr graph,
                                 Node parent1,
                                 Node parent2) :
-                        AbstractOperator(graph, "LessThanOrEqual"), BinaryOperator(parent1, parent2) {};
+                        AbstractOperator(graph, OpKind::LessThanOrEqual), BinaryOperator(parent1, parent2) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<LessThanOrEqual>(graph, ancestors[0], ancestors[1]);
+                    return make_operator<LessThanOrEqual>(graph, ancestors[0], ancestors[1]);
+                }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
                 }
             };
 
@@ -104,10 +132,14 @@ namespace md {
                 Equals(GraphInPtr graph,
                        Node parent1,
                        Node parent2) :
-                        AbstractOperator(graph, "Equals"), BinaryOperator(parent1, parent2) {};
+                        AbstractOperator(graph, OpKind::Equals), BinaryOperator(parent1, parent2) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Equals>(graph, ancestors[0], ancestors[1]);
+                    return make_operator<Equals>(graph, ancestors[0], ancestors[1]);
+                }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
                 }
             };
 
@@ -117,10 +149,14 @@ namespace md {
                 NotEquals(GraphInPtr graph,
                           Node parent1,
                           Node parent2) :
-                        AbstractOperator(graph, "NotEquals"), BinaryOperator(parent1, parent2) {};
+                        AbstractOperator(graph, OpKind::NotEquals), BinaryOperator(parent1, parent2) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<NotEquals>(graph, ancestors[0], ancestors[1]);
+                    return make_operator<NotEquals>(graph, ancestors[0], ancestors[1]);
+                }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
                 }
             };
 
@@ -133,11 +169,19 @@ namespace md {
                                     Node parent1,
                                     Node parent2,
                                     double tolerance) :
-                        AbstractOperator(graph, "ApproximatelyEquals"), BinaryOperator(parent1, parent2),
+                        AbstractOperator(graph, OpKind::ApproximatelyEquals), BinaryOperator(parent1, parent2),
                         tolerance(tolerance) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<ApproximatelyEquals>(graph, ancestors[0], ancestors[1], tolerance);
+                    return make_operator<ApproximatelyEquals>(graph, ancestors[0], ancestors[1], tolerance);
+                }
+
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const ApproximatelyEquals>(op);
+                        return tolerance == cast_op->tolerance;
+                    }
+                    return false;
                 }
             };
 
@@ -145,10 +189,14 @@ namespace md {
             class IsNaN : public LogicalUnaryElementwise {
             public:
                 IsNaN(GraphInPtr const graph, Node parent) :
-                        AbstractOperator(graph, "IsNaN"), UnaryOperator(parent) {};
+                        AbstractOperator(graph, OpKind::IsNaN), UnaryOperator(parent) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<IsNaN>(graph, ancestors[0]);
+                    return make_operator<IsNaN>(graph, ancestors[0]);
+                }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
                 }
             };
 
@@ -156,10 +204,14 @@ namespace md {
             class IsInf : public LogicalUnaryElementwise {
             public:
                 IsInf(GraphInPtr const graph, Node parent) :
-                        AbstractOperator(graph, "IsInf"), UnaryOperator(parent) {};
+                        AbstractOperator(graph, OpKind::IsInf), UnaryOperator(parent) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<IsInf>(graph, ancestors[0]);
+                    return make_operator<IsInf>(graph, ancestors[0]);
+                }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
                 }
             };
         }
@@ -81,7 +81,7 @@ namespace metadiff{
             }
 
             std::shared_ptr<Operator> copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                return std::make_shared<MultiNodeIndex>(graph, ancestors[0], index);
+                return make_operator<MultiNodeIndex>(graph, ancestors[0], index);
             }
 
             Shape get_shape() const {
@@ -171,12 +171,13 @@ namespace metadiff{
                 // The max should always be the first child
                 if(index == 0){
                     Node argmax;
-                    if(parent->children[0]->id != result->id){
-                        argmax = parent->children[0];
+                    IdRange const children = graph->edges.children(parent.id);
+                    if(children[0] != result.id){
+                        argmax = graph->nodes[children[0]];
                     } else {
-                        argmax = parent->children[1];
+                        argmax = graph->nodes[children[1]];
                     }
-//                    return graph->derived_node(std::make_shared<IndexGrad>(graph,
+//                    return graph->derived_node(make_operator<IndexGrad>(graph,
 //                                                                           my_grad,
 //                                                                           result.argmax(axis), axis,
 //                                                                           result->shape[axis]));
@@ -189,7 +190,7 @@ namespace metadiff{
             }
 
             std::shared_ptr<Operator> copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                return std::make_shared<MaxAndArgMax>(graph, ancestors[0], axis);
+                return make_operator<MaxAndArgMax>(graph, ancestors[0], axis);
             }
         };
 
@@ -240,12 +241,13 @@ namespace metadiff{
                 // The max should always be the first child
                 if(index == 0){
                     Node argsort;
-                    if(parent->children[0]->id != result->id){
-                        argsort = parent->children[0];
+                    IdRange const children = graph->edges.children(parent.id);
+                    if(children[0] != result.id){
+                        argsort = graph->nodes[children[0]];
                     } else {
-                        argsort = parent->children[1];
+                        argsort = graph->nodes[children[1]];
                     }
-//                    return graph->derived_node(std::make_shared<IndexGrad>(graph,
+//                    return graph->derived_node(make_operator<IndexGrad>(graph,
 //                                                                           my_grad,
 //                                                                           result.argmax(axis), axis,
 //                                                                           result->shape[axis]));
@@ -258,7 +260,7 @@ namespace metadiff{
             }
 
             std::shared_ptr<Operator> copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                return std::make_shared<MaxAndArgMax>(graph, ancestors[0], axis);
+                return make_operator<MaxAndArgMax>(graph, ancestors[0], axis);
             }
         };
     }
@@ -14,17 +14,24 @@ namespace md {
             public:
                 double threshold;
                 Softplus(GraphInPtr graph, Node parent, double threshold = 50) :
-                        AbstractOperator(graph, "Softplus"), UnaryOperator(parent),
+                        AbstractOperator(graph, OpKind::Softplus), UnaryOperator(parent),
                         threshold(threshold){};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Softplus>(graph, ancestors[0], threshold);
+                    return make_operator<Softplus>(graph, ancestors[0], threshold);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index){
                     return mul(my_derivative, sigmoid(parent));
                 }
 
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const Softplus>(op);
+                        return threshold == cast_op->threshold;
+                    }
+                    return false;
+                }
             };
 
             /** Logarithm of sum exp(x_i) */
@@ -32,11 +39,11 @@ namespace md {
             public:
                 double threshold;
                 LogSumExp(GraphInPtr graph, Node parent, Axes axes, double threshold = 10) :
-                        AbstractOperator(graph, "LogSumExp"), UnaryOperator(parent), ReductionOperator(axes),
+                        AbstractOperator(graph, OpKind::LogSumExp), UnaryOperator(parent), ReductionOperator(axes),
                         threshold(threshold){};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<LogSumExp>(graph, ancestors[0], axes, threshold);
+                    return make_operator<LogSumExp>(graph, ancestors[0], axes, threshold);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index){
@@ -47,6 +54,14 @@ namespace md {
                     auto s = softmax(parent_derivatives[index]);
                     return sum(mul(parent_derivatives[index], s), axes);
                 }
+
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const LogSumExp>(op);
+                        return axes == cast_op->axes and threshold == cast_op->threshold;
+                    }
+                    return false;
+                }
             };
 
 
@@ -54,15 +69,19 @@ namespace md {
             class Sigmoid : public FloatUnaryElementwiseOperator {
             public:
                 Sigmoid(GraphInPtr graph, Node parent) :
-                        AbstractOperator(graph, "Sigmoid"), UnaryOperator(parent) {};
+                        AbstractOperator(graph, OpKind::Sigmoid), UnaryOperator(parent) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Sigmoid>(graph, ancestors[0]);
+                    return make_operator<Sigmoid>(graph, ancestors[0]);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index){
                     return mul(my_derivative, result, neg(graph->constant(1), result));
                 }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
 
             /** Softmax function */
@@ -70,17 +89,25 @@ namespace md {
             public:
                 Axes axes;
                 Softmax(GraphInPtr graph, Node parent, Axes axes) :
-                        AbstractOperator(graph, "Softmax"), UnaryOperator(parent),
+                        AbstractOperator(graph, OpKind::Softmax), UnaryOperator(parent),
                         axes(axes) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Softmax>(graph, ancestors[0], axes);
+                    return make_operator<Softmax>(graph, ancestors[0], axes);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index){
                     auto vtg = sum(mul(my_derivative, result), axes);
                     return neg(mul(result, my_derivative), mul(result, vtg));
                 }
+
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const Softmax>(op);
+                        return axes == cast_op->axes;
+                    }
+                    return false;
+                }
             };
 
             /** The Binary cross entropy of p and q = sigmoid(x) */
@@ -88,13 +115,13 @@ namespace md {
             public:
                 Node softplus_x, softplus_minus_x;
                 BinaryCrossEntropyLogits(GraphInPtr graph, Node p, Node x):
-                        AbstractOperator(graph, "BinaryCrossEntropyLogits"), BinaryOperator(p, x){
+                        AbstractOperator(graph, OpKind::BinaryCrossEntropyLogits), BinaryOperator(p, x){
                     softplus_x = softplus(x);
                     softplus_minus_x = softplus(neg(x));
                 }
 
                 Operator copy_to(GraphInPtr graph, std::vector <Node> ancestors) const {
-                    return std::make_shared<BinaryCrossEntropyLogits>(graph, ancestors[0], ancestors[1]);
+                    return make_operator<BinaryCrossEntropyLogits>(graph, ancestors[0], ancestors[1]);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index){
@@ -112,6 +139,10 @@ namespace md {
                         return mul(my_derivative, neg(sigmoid(parent2), parent1));
                     }
                 }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
 
             /**
@@ -122,12 +153,12 @@ namespace md {
             public:
                 Node log_z;
                 CategoricalCrossEntropyLogits(GraphInPtr graph, Node p, Node x):
-                        AbstractOperator(graph, "CategoricalCrossEntropyLogits"), BinaryOperator(p, x){
+                        AbstractOperator(graph, OpKind::CategoricalCrossEntropyLogits), BinaryOperator(p, x){
                     log_z = log_sum_exp(x);
                 }
 
                 Operator copy_to(GraphInPtr graph, std::vector <Node> ancestors) const {
-                    return std::make_shared<CategoricalCrossEntropyLogits>(graph, ancestors[0], ancestors[1]);
+                    return make_operator<CategoricalCrossEntropyLogits>(graph, ancestors[0], ancestors[1]);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index) {
@@ -141,6 +172,10 @@ namespace md {
                         return mul(my_derivative, neg(parent1, softmax(parent2)));
                     }
                 }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
         }
     }
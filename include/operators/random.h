@@ -14,18 +14,21 @@ namespace md{
                 Shape shape;
 
                 RandomUniform(GraphInPtr graph, Shape shape) :
-                        AbstractOperator(graph, "RandomUniform"),
+                        AbstractOperator(graph, OpKind::RandomUniform),
                         ConstantOperator(DataType(FLOAT, graph->props.max_float)),
                         shape(shape) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<RandomUniform>(graph, shape);
+                    return make_operator<RandomUniform>(graph, shape);
                 }
 
                 Shape get_shape() const {
                     return shape;
                 }
 
+                size_t hash() const {
+                    return std::hash<AbstractOperator const *>()(this);
+                }
             };
 
             /** Node filled with normally distributed random numbers */
@@ -34,17 +37,20 @@ namespace md{
                 Shape shape;
 
                 RandomNormal(GraphInPtr graph, Shape shape) :
-                        AbstractOperator(graph, "RandomNormal"), ConstantOperator(DataType(FLOAT, graph->props.max_float)),
+                        AbstractOperator(graph, OpKind::RandomNormal), ConstantOperator(DataType(FLOAT, graph->props.max_float)),
                         shape(shape) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<RandomNormal>(graph, shape);
+                    return make_operator<RandomNormal>(graph, shape);
                 }
 
                 Shape get_shape() const {
                     return shape;
                 }
 
+                size_t hash() const {
+                    return std::hash<AbstractOperator const *>()(this);
+                }
             };
         }
     }
@@ -13,10 +13,10 @@ namespace md{
                 Sum(GraphInPtr graph,
                     Node parent,
                     Axes axes) :
-                        AbstractOperator(graph, "Sum"), UnaryOperator(parent), ReductionOperator(axes) {};
+                        AbstractOperator(graph, OpKind::Sum), UnaryOperator(parent), ReductionOperator(axes) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Sum>(graph, ancestors[0], axes);
+                    return make_operator<Sum>(graph, ancestors[0], axes);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index){
@@ -26,6 +26,14 @@ namespace md{
                 Node forward_diff_parent(NodeVec & parent_derivatives, int index){
                     return sum(parent_derivatives[index], axes);
                 }
+
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const Sum>(op);
+                        return axes == cast_op->axes;
+                    }
+                    return false;
+                }
             };
 
             /** Product along axes */
@@ -34,10 +42,10 @@ namespace md{
                 Product(GraphInPtr graph,
                         Node parent,
                         Axes axes) :
-                        AbstractOperator(graph, "Product"), UnaryOperator(parent), ReductionOperator(axes) {};
+                        AbstractOperator(graph, OpKind::Product), UnaryOperator(parent), ReductionOperator(axes) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Product>(graph, ancestors[0], axes);
+                    return make_operator<Product>(graph, ancestors[0], axes);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index){
@@ -48,6 +56,14 @@ namespace md{
                     auto factor = div(parent_derivatives[index], parent);
                     return sum(mul(result, factor), axes);
                 }
+
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const Product>(op);
+                        return axes == cast_op->axes;
+                    }
+                    return false;
+                }
             };
 
             /** Mean along axes */
@@ -56,10 +72,10 @@ namespace md{
                 Mean(GraphInPtr graph,
                      Node parent,
                      Axes axes) :
-                        AbstractOperator(graph, "Mean"), UnaryOperator(parent), ReductionOperator(axes) {};
+                        AbstractOperator(graph, OpKind::Mean), UnaryOperator(parent), ReductionOperator(axes) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Mean>(graph, ancestors[0], axes);
+                    return make_operator<Mean>(graph, ancestors[0], axes);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index){
@@ -73,6 +89,14 @@ namespace md{
                 Node forward_diff_parent(NodeVec & parent_derivatives, int index){
                     return mean(parent_derivatives[index], axes);
                 }
+
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const Mean>(op);
+                        return axes == cast_op->axes;
+                    }
+                    return false;
+                }
             };
 
             /** Variance along axes */
@@ -81,10 +105,10 @@ namespace md{
                 Variance(GraphInPtr graph,
                          Node parent,
                          Axes axes) :
-                        AbstractOperator(graph, "Variance"), UnaryOperator(parent), ReductionOperator(axes) {};
+                        AbstractOperator(graph, OpKind::Variance), UnaryOperator(parent), ReductionOperator(axes) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Mean>(graph, ancestors[0], axes);
+                    return make_operator<Mean>(graph, ancestors[0], axes);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index){
@@ -107,6 +131,14 @@ namespace md{
                     auto centered_d = neg(parent_derivatives[index], mean(parent_derivatives[index], axes));
                     return mean(mul(two, centered, centered_d), axes);
                 }
+
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const Variance>(op);
+                        return axes == cast_op->axes;
+                    }
+                    return false;
+                }
             };
 
             /** Reducation with operator AND (&&) along an axes */
@@ -115,10 +147,18 @@ namespace md{
                 AllTrue(GraphInPtr graph,
                         Node parent,
                         Axes axes) :
-                        AbstractOperator(graph, "AllTrue"), UnaryOperator(parent), ReductionOperator(axes) {};
+                        AbstractOperator(graph, OpKind::AllTrue), UnaryOperator(parent), ReductionOperator(axes) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<AllTrue>(graph, ancestors[0], axes);
+                    return make_operator<AllTrue>(graph, ancestors[0], axes);
+                }
+
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const AllTrue>(op);
+                        return axes == cast_op->axes;
+                    }
+                    return false;
                 }
             };
 
@@ -128,10 +168,18 @@ namespace md{
                 AnyTrue(GraphInPtr graph,
                         Node parent,
                         Axes axes) :
-                        AbstractOperator(graph, "AnyTrue"), UnaryOperator(parent), ReductionOperator(axes) {};
+                        AbstractOperator(graph, OpKind::AnyTrue), UnaryOperator(parent), ReductionOperator(axes) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<AnyTrue>(graph, ancestors[0], axes);
+                    return make_operator<AnyTrue>(graph, ancestors[0], axes);
+                }
+
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const AnyTrue>(op);
+                        return axes == cast_op->axes;
+                    }
+                    return false;
                 }
             };
 
@@ -143,12 +191,12 @@ namespace md{
                 bool only_indices;
                 MaxMinAndArgMaxMin(GraphInPtr graph, Node parent, Axes axes, bool max,
                                    bool only_values = false, bool only_indices = false):
-                        AbstractOperator(graph, "MaxMinAndArgMaxMin"), UnaryOperator(parent),
+                        AbstractOperator(graph, OpKind::MaxMinAndArgMaxMin), UnaryOperator(parent),
                         MultiOutputOperator(2), ReductionOperator(axes),
                         max(max), only_values(only_values), only_indices(only_indices){};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<MaxMinAndArgMaxMin>(graph, ancestors[0], axes, max, only_values, only_indices);
+                    return make_operator<MaxMinAndArgMaxMin>(graph, ancestors[0], axes, max, only_values, only_indices);
                 }
 
                 Shape get_shape() const {
@@ -184,6 +232,13 @@ namespace md{
                     }
                 }
 
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const MaxMinAndArgMaxMin>(op);
+                        return axes == cast_op->axes and max == cast_op->max and only_values == cast_op->only_values and only_indices == cast_op->only_indices;
+                    }
+                    return false;
+                }
             };
 
             /** Reduction which returns the Max values and their indices along a single axis */
@@ -195,12 +250,12 @@ namespace md{
                 bool only_arg_sort;
                 SortAndArgSort(GraphInPtr graph, Node parent, int axis, bool ascending,
                                bool only_sort = false, bool only_arg_sort = false):
-                        AbstractOperator(graph, "SortAndArgSort"), UnaryOperator(parent),
+                        AbstractOperator(graph, OpKind::SortAndArgSort), UnaryOperator(parent),
                         MultiOutputOperator(2), axis(axis),
                         ascending(ascending), only_sort(only_sort), only_arg_sort(only_arg_sort){};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<SortAndArgSort>(graph, ancestors[0], axis, ascending, only_sort, only_arg_sort);
+                    return make_operator<SortAndArgSort>(graph, ancestors[0], axis, ascending, only_sort, only_arg_sort);
                 }
 
                 Shape get_shape() const {
@@ -235,6 +290,14 @@ namespace md{
                         return Node();
                     }
                 }
+
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const SortAndArgSort>(op);
+                        return axis == cast_op->axis and ascending == cast_op->ascending and only_sort == cast_op->only_sort and only_arg_sort == cast_op->only_arg_sort;
+                    }
+                    return false;
+                }
             };
         }
     }
@@ -16,10 +16,10 @@ namespace md{
             class Diagonal : public MorphOperator {
             public:
                 Diagonal(GraphInPtr graph, Node parent) :
-                        AbstractOperator(graph, "Diagonal"), UnaryOperator(parent) {};
+                        AbstractOperator(graph, OpKind::Diagonal), UnaryOperator(parent) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Diagonal>(graph, ancestors[0]);
+                    return make_operator<Diagonal>(graph, ancestors[0]);
                 }
 
                 Shape get_shape() const {
@@ -37,6 +37,10 @@ namespace md{
                 Node forward_diff_parent(NodeVec & parent_derivatives, int index){
                     return diag(parent_derivatives[index]);
                 }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
 
             /** Takes the lower triangular part of a matrix */
@@ -44,11 +48,11 @@ namespace md{
             public:
                 double k;
                 LowerTriangular(GraphInPtr graph, Node parent, double k) :
-                        AbstractOperator(graph, "LowerTriangular"), UnaryOperator(parent),
+                        AbstractOperator(graph, OpKind::LowerTriangular), UnaryOperator(parent),
                         k(k) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<LowerTriangular>(graph, ancestors[0], k);
+                    return make_operator<LowerTriangular>(graph, ancestors[0], k);
                 }
 
                 Shape get_shape() const {
@@ -62,6 +66,14 @@ namespace md{
                 Node forward_diff_parent(NodeVec & parent_derivatives, int index){
                     return lower_tri(parent_derivatives[index], k);
                 }
+
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const LowerTriangular>(op);
+                        return k == cast_op->k;
+                    }
+                    return false;
+                }
             };
 
             /** Takes the upper triangular part of a matrix */
@@ -69,11 +81,11 @@ namespace md{
             public:
                 double k;
                 UpperTriangular(GraphInPtr graph, Node parent, double k) :
-                        AbstractOperator(graph, "UpperTriangular"), UnaryOperator(parent),
+                        AbstractOperator(graph, OpKind::UpperTriangular), UnaryOperator(parent),
                         k(k){};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<UpperTriangular>(graph, ancestors[0], k);
+                    return make_operator<UpperTriangular>(graph, ancestors[0], k);
                 }
 
                 Shape get_shape() const {
@@ -87,6 +99,14 @@ namespace md{
                 Node forward_diff_parent(NodeVec & parent_derivatives, int index){
                     return upper_tri(parent_derivatives[index], k);
                 }
+
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const UpperTriangular>(op);
+                        return k == cast_op->k;
+                    }
+                    return false;
+                }
             };
 
             /** Reshapes the input to a specified shape */
@@ -95,11 +115,11 @@ namespace md{
                 Shape shape;
 
                 Reshape(GraphInPtr graph, Node parent, Shape shape) :
-                        AbstractOperator(graph, "Reshape"), UnaryOperator(parent),
+                        AbstractOperator(graph, OpKind::Reshape), UnaryOperator(parent),
                         shape(shape) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Reshape>(graph, ancestors[0], shape);
+                    return make_operator<Reshape>(graph, ancestors[0], shape);
                 }
 
                 Shape get_shape() const {
@@ -114,13 +134,13 @@ namespace md{
                     return reshape(parent_derivatives[index], shape);
                 }
 
-//                bool equals(Operator const op) const {
-//                    if (name == op->name) {
-//                        auto cast_op = std::static_pointer_cast<const Reshape>(op);
-//                        return symbolic_equals(parent, cast_op->parent) and shape == cast_op->shape;
-//                    }
-//                    return false;
-//                }
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const Reshape>(op);
+                        return shape == cast_op->shape;
+                    }
+                    return false;
+                }
             };
 
 
@@ -132,11 +152,11 @@ namespace md{
                 Reorder(GraphInPtr graph,
                         Node parent,
                         Axes order) :
-                        AbstractOperator(graph, "Reorder"), UnaryOperator(parent),
+                        AbstractOperator(graph, OpKind::Reorder), UnaryOperator(parent),
                         order(order) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Reorder>(graph, ancestors[0], order);
+                    return make_operator<Reorder>(graph, ancestors[0], order);
                 }
 
                 Shape get_shape() const {
@@ -167,13 +187,13 @@ namespace md{
                     return reorder(parent_derivatives[index], order);
                 }
 
-//                bool equals(Operator const op) const {
-//                    if (name == op->name) {
-//                        auto cast_op = std::static_pointer_cast<const Reorder>(op);
-//                        return symbolic_equals(parent, cast_op->parent) and order == cast_op->order;
-//                    }
-//                    return false;
-//                }
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const Reorder>(op);
+                        return order == cast_op->order;
+                    }
+                    return false;
+                }
             };
 
             /** Filps the elements along the axes of tensor */
@@ -184,11 +204,11 @@ namespace md{
                 Flip(GraphInPtr graph,
                         Node parent,
                         Axes axes) :
-                        AbstractOperator(graph, "Flip"), UnaryOperator(parent),
+                        AbstractOperator(graph, OpKind::Flip), UnaryOperator(parent),
                         axes(axes) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Flip>(graph, ancestors[0], axes);
+                    return make_operator<Flip>(graph, ancestors[0], axes);
                 }
 
                 Shape get_shape() const {
@@ -203,13 +223,13 @@ namespace md{
                     return flip(parent_derivatives[index], axes);
                 }
 
-//                bool equals(Operator const op) const {
-//                    if (name == op->name) {
-//                        auto cast_op = std::static_pointer_cast<const Reorder>(op);
-//                        return symbolic_equals(parent, cast_op->parent) and order == cast_op->order;
-//                    }
-//                    return false;
-//                }
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const Flip>(op);
+                        return axes == cast_op->axes;
+                    }
+                    return false;
+                }
             };
         }
     }
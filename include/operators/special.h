@@ -13,7 +13,7 @@ namespace md{
             public:
                 int index;
                 MultiOutputIndex(GraphInPtr const graph, Node const parent, int index):
-                        AbstractOperator(graph, "MultiOutputIndex"), UnaryOperator(parent),
+                        AbstractOperator(graph, OpKind::MultiOutputIndex), UnaryOperator(parent),
                         index(index) {
                     auto parent_op = std::dynamic_pointer_cast<MultiOutputOperator>(parent->op);
                     if(not parent_op){
@@ -26,7 +26,7 @@ namespace md{
                 }
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<MultiOutputIndex>(graph, ancestors[0], index);
+                    return make_operator<MultiOutputIndex>(graph, ancestors[0], index);
                 }
 
                 Shape get_shape() const {
@@ -52,6 +52,14 @@ namespace md{
                     auto parent_op = std::dynamic_pointer_cast<MultiOutputOperator>(parent->op);
                     return parent_op->forward_diff_parent_at(parent_derivatives, this->index);
                 }
+
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const MultiOutputIndex>(op);
+                        return index == cast_op->index;
+                    }
+                    return false;
+                }
             };
 
             /** Casting to a specified DataType */
@@ -60,7 +68,7 @@ namespace md{
                 DataType data_type;
 
                 Cast(GraphInPtr graph, Node parent, DataType data_type) :
-                        AbstractOperator(graph, "Cast"), UnaryOperator(parent),
+                        AbstractOperator(graph, OpKind::Cast), UnaryOperator(parent),
                         data_type(data_type) {};
 
                 DataType get_data_type() const {
@@ -68,7 +76,7 @@ namespace md{
                 };
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Cast>(graph, ancestors[0], data_type);
+                    return make_operator<Cast>(graph, ancestors[0], data_type);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index){
@@ -79,23 +87,23 @@ namespace md{
                     return cast(parent_derivatives[index], data_type);
                 }
 
-//                bool equals(Operator const op) const {
-//                    if (name == op->name) {
-//                        auto cast_op = std::static_pointer_cast<const Cast>(op);
-//                        return symbolic_equals(parent, cast_op->parent) and data_type == cast_op->data_type;
-//                    }
-//                    return false;
-//                }
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const Cast>(op);
+                        return data_type == cast_op->data_type;
+                    }
+                    return false;
+                }
             };
 
             /** An alias/view of another node. */
             class Alias : public MorphElementwiseOperator {
             public:
                 Alias(GraphInPtr graph, Node parent) :
-                        AbstractOperator(graph, "Alias"), UnaryOperator(parent) {};
+                        AbstractOperator(graph, OpKind::Alias), UnaryOperator(parent) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Alias>(graph, ancestors[0]);
+                    return make_operator<Alias>(graph, ancestors[0]);
                 }
 
                 Node backward_diff_parent(Node my_derivative, int index){
@@ -121,11 +129,11 @@ namespace md{
                 Broadcast(GraphInPtr graph,
                           Node parent,
                           Shape to_shape) :
-                        AbstractOperator(graph, "Broadcast"), UnaryOperator(parent),
+                        AbstractOperator(graph, OpKind::Broadcast), UnaryOperator(parent),
                         to_shape(to_shape) {}
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Broadcast>(graph, ancestors[0], to_shape);
+                    return make_operator<Broadcast>(graph, ancestors[0], to_shape);
                 }
 
                 Shape get_shape() const {
@@ -147,13 +155,13 @@ namespace md{
                     return broadcast(parent_derivatives[index], to_shape);
                 }
 
-//                bool equals(Operator const op) const {
-//                    if (name == op->name) {
-//                        auto cast_op = std::static_pointer_cast<const Broadcast>(op);
-//                        return symbolic_equals(parent, cast_op->parent) and to_shape == cast_op->to_shape;
-//                    }
-//                    return false;
-//                }
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const Broadcast>(op);
+                        return to_shape == cast_op->to_shape;
+                    }
+                    return false;
+                }
             };
 
             /** View of the node, which is non-differentiable */
@@ -161,10 +169,10 @@ namespace md{
             public:
                 MakeConstant(GraphInPtr graph,
                              Node parent) :
-                        AbstractOperator(graph, "MakeConstant"), UnaryOperator(parent) {};
+                        AbstractOperator(graph, OpKind::MakeConstant), UnaryOperator(parent) {};
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<MakeConstant>(graph, ancestors[0]);
+                    return make_operator<MakeConstant>(graph, ancestors[0]);
                 }
 
                 bool is_differentiable() const{
@@ -178,6 +186,10 @@ namespace md{
                 Node forward_diff_parent(NodeVec & parent_derivatives, int index){
                     return Node();
                 }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
 
             /** Elementwise selects one of the two parents based on the condition */
@@ -189,7 +201,7 @@ namespace md{
                        Node condition,
                        Node trueParent,
                        Node falseParent) :
-                        AbstractOperator(graph, "Select"), BinaryOperator(trueParent, falseParent),
+                        AbstractOperator(graph, OpKind::Select), BinaryOperator(trueParent, falseParent),
                         condition(condition) {};
 
                 DataType get_data_type() const {
@@ -197,7 +209,7 @@ namespace md{
                 }
 
                 Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
-                    return std::make_shared<Select>(graph, ancestors[2], ancestors[0], ancestors[1]);
+                    return make_operator<Select>(graph, ancestors[2], ancestors[0], ancestors[1]);
                 }
 
                 NodeVec get_arguments() const {
@@ -219,8 +231,8 @@ namespace md{
 
                 Node forward_diff_parent(NodeVec & parent_derivatives, int index){
                     // We have to simulate this correctly
-                    int c = (not parent_derivatives[0].ptr.expired()) +
-                            (not parent_derivatives[0].ptr.expired());
+                    int c = (not parent_derivatives[0].empty()) +
+                            (not parent_derivatives[0].empty());
                     if(c == 2){
                         if(index == 0){
                             return select(condition, parent_derivatives[0], parent_derivatives[1]);
@@ -236,6 +248,10 @@ namespace md{
                     }
                     return Node();
                 }
+
+                bool equals(Operator const op) const {
+                    return same_ancestors(op);
+                }
             };
         }
     }
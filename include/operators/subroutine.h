@@ -0,0 +1,82 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#ifndef METADIFF_GRAPH_IR_OPERATORS_SUBROUTINE_H
+#define METADIFF_GRAPH_IR_OPERATORS_SUBROUTINE_H
+
+namespace md{
+    namespace gir{
+        namespace op{
+            /** A call of a subroutine body with the parents as its inputs, resulting in one of its outputs */
+            class SubRoutine: public virtual AbstractOperator {
+            public:
+                SubRoutinePtr body;
+                NodeVec args;
+                int output;
+
+                SubRoutine(GraphInPtr graph, SubRoutinePtr body, NodeVec args, int output):
+                        AbstractOperator(graph, OpKind::SubRoutine),
+                        body(body), args(args), output(output) {};
+
+                Operator copy_to(GraphInPtr graph, NodeVec ancestors) const {
+                    return make_operator<SubRoutine>(graph, body, ancestors, output);
+                }
+
+                NodeVec get_parents() const {
+                    return args;
+                }
+
+                DataType get_data_type() const {
+                    return body->function.outputs[output]->data_type;
+                }
+
+                Shape get_shape() const {
+                    return body->function.outputs[output]->shape;
+                }
+
+                /** Broadcasts and casts the derivative to the shape and type of the node, only where they differ */
+                static Node conform(Node derivative, Node const node){
+                    if(derivative->shape != node->shape){
+                        derivative = api::broadcast(derivative, node->shape);
+                    }
+                    if(derivative->data_type != node->data_type){
+                        derivative = api::cast(derivative, node->data_type);
+                    }
+                    return derivative;
+                }
+
+                Node backward_diff_parent(Node my_derivative, int index){
+                    auto const & derivative = body->backward(output);
+                    Node const parent = parents_view()[index];
+                    if(derivative.index[index] < 0){
+                        return graph->zeros(parent->shape, parent->data_type);
+                    }
+                    NodeVec derivative_args = args;
+                    derivative_args.push_back(conform(my_derivative, result));
+                    return graph->derived_node(make_operator<SubRoutine>(graph, derivative.body, derivative_args,
+                                                                         derivative.index[index]));
+                }
+
+                Node forward_diff_parent(NodeVec & parent_derivatives, int index){
+                    auto const & derivative = body->forward(output, index);
+                    if(not derivative.body){
+                        return Node();
+                    }
+                    NodeVec derivative_args = args;
+                    derivative_args.push_back(conform(parent_derivatives[index], parents_view()[index]));
+                    return graph->derived_node(make_operator<SubRoutine>(graph, derivative.body, derivative_args, 0));
+                }
+
+                bool equals(Operator const op) const {
+                    if (same_ancestors(op)) {
+                        auto cast_op = std::dynamic_pointer_cast<const SubRoutine>(op);
+                        return body == cast_op->body and output == cast_op->output;
+                    }
+                    return false;
+                }
+            };
+        }
+    }
+}
+#endif //METADIFF_GRAPH_IR_OPERATORS_SUBROUTINE_H
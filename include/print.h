@@ -31,6 +31,12 @@ namespace md{
             return f << to_string(policy);
         }
 
+        std::string to_string(DiffMode const mode);
+
+        inline std::ostream &operator<<(std::ostream &f, DiffMode const mode) {
+            return f << to_string(mode);
+        }
+
         std::string to_string(Shape const shape);
 
         inline std::ostream &operator<<(std::ostream &f, Shape const shape) {
@@ -0,0 +1,103 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#ifndef METADIFF_GRAPH_IR_SCOPE_TABLE_H
+#define METADIFF_GRAPH_IR_SCOPE_TABLE_H
+
+namespace md{
+    namespace gir{
+        /** The id of a scope interned in the ScopeTable of a graph */
+        typedef uint32_t ScopeId;
+
+        /**
+         * A per graph interning table of the hierarchical scopes (groups) of the nodes.
+         * Each scope is stored only once together with the id of its parent, so that nodes keep only the id,
+         * while the full name is built only once, when the scope is first created.
+         * The root scope has an empty name and the id 0.
+         */
+        class ScopeTable {
+        public:
+            /** The id of the root scope */
+            static ScopeId const root = 0;
+
+            ScopeTable();
+
+            ScopeTable(ScopeTable const & table) = delete;
+
+            /** @brief Returns the number of scopes in the table, including the root
+             *
+             * @return
+             */
+            size_t size() const {
+                return scopes.size();
+            }
+
+            /** @brief Returns the id of the child scope of the parent with the name, adding it if it is not there
+             *
+             * @param parent
+             * @param name
+             * @param delimiter - the delimiter between the names in the full name
+             * @return
+             */
+            ScopeId child(ScopeId const parent, std::string const & name, std::string const & delimiter);
+
+            /** @brief Returns the id of the scope with the full name, adding it and its parents if they are not there.
+             * Empty names between the delimiters are skipped, so the empty string is the root.
+             *
+             * @param full_name
+             * @param delimiter
+             * @return
+             */
+            ScopeId intern(std::string const & full_name, std::string const & delimiter);
+
+            /** @brief Returns the id in this table of a scope from another table, adding it if it is not there
+             *
+             * @param table
+             * @param id
+             * @param delimiter
+             * @return
+             */
+            ScopeId import(ScopeTable const & table, ScopeId const id, std::string const & delimiter);
+
+            /** @brief Returns the id of the parent of the scope, the parent of the root is the root
+             *
+             * @param id
+             * @return
+             */
+            ScopeId parent(ScopeId const id) const {
+                return scopes[id].parent;
+            }
+
+            /** @brief Returns the name of the scope, without the names of its parents
+             *
+             * @param id
+             * @return
+             */
+            std::string const & name(ScopeId const id) const {
+                return scopes[id].name;
+            }
+
+            /** @brief Returns the names of the scope and all of its parents, joined by the delimiter
+             *
+             * @param id
+             * @return
+             */
+            std::string const & full_name(ScopeId const id) const {
+                return scopes[id].full_name;
+            }
+
+        private:
+            struct Scope {
+                ScopeId parent;
+                std::string name;
+                std::string full_name;
+            };
+            /** All of the scopes, indexed by their id */
+            std::vector<Scope> scopes;
+            /** Mapping the full name of each scope to its id */
+            std::unordered_map<std::string, ScopeId> ids;
+        };
+    }
+}
+#endif //METADIFF_GRAPH_IR_SCOPE_TABLE_H
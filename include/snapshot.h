@@ -0,0 +1,41 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#ifndef METADIFF_GRAPH_IR_SNAPSHOT_H
+#define METADIFF_GRAPH_IR_SNAPSHOT_H
+
+namespace md{
+    namespace gir{
+        /**
+         * A point in the history of a graph, taken by GraphInternal::snapshot(), to which the graph can be rolled back.
+         * Since nodes are only ever appended, the snapshot shares all of the nodes and operators with the graph and
+         * holds only its sizes and the few values which are replaced rather than appended to.
+         * Anything appended after it is removed on a rollback, and the in place changes of older nodes
+         * are undone from the journal of the graph.
+         */
+        class Snapshot {
+        public:
+            /** The graph of the snapshot */
+            GraphInPtr graph;
+            /** The version of the snapshot, unique within the graph */
+            size_t version;
+            /** The number of nodes at the time of the snapshot */
+            size_t num_nodes;
+            /** The number of records in the journal of the graph at the time of the snapshot */
+            size_t journal_size;
+            Updates updates;
+            ScopeId scope;
+            unsigned int grad_level;
+        };
+
+        /** The fields of a node which are modified in place, saved before the modification */
+        class NodeRecord {
+        public:
+            size_t id;
+            std::string name;
+            unsigned int grad_level;
+        };
+    }
+}
+#endif //METADIFF_GRAPH_IR_SNAPSHOT_H
@@ -0,0 +1,86 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#ifndef METADIFF_GRAPH_IR_SUBROUTINE_H
+#define METADIFF_GRAPH_IR_SUBROUTINE_H
+
+namespace md{
+    namespace gir{
+        /**
+         * The body of a subroutine - a computation defined once, in a graph of its own, and called from
+         * any number of sites (see api::call()) without being inlined. Each call site is a single SubRoutine
+         * Node per output, which refers to the body.
+         * The derivatives of the body are computed only once, in the graph of the body, and are themselves
+         * bodies, which the derivatives of the call sites call.
+         * The shapes of the arguments at a call site must be the same as those of the inputs of the body,
+         * hence a body defined over symbolic sizes can be called with any arguments of those sizes.
+         * Bodies can not contain parameters or updates, the parameters should be passed as arguments.
+         */
+        class SubRoutineBody {
+        public:
+            /** The name of the body */
+            std::string const name;
+            /** A unique id of the body, for the backends */
+            size_t const id;
+            /** The inputs and the outputs of the body, as a view of its graph */
+            GraphFunction const function;
+
+            SubRoutineBody(std::string const name,
+                           Graph const graph,
+                           NodeVec const inputs,
+                           NodeVec const outputs);
+
+            /** The derivative of a single output with respect to all of the inputs which it depends on */
+            class Derivative {
+            public:
+                /** The body computing the derivatives, or nullptr if the output depends on none of the inputs */
+                SubRoutinePtr body;
+                /** For each input, the index of its derivative among the outputs of body, or -1 if there is none */
+                std::vector<int> index;
+            };
+
+            /** @brief Returns the body of the backward derivative of the output.
+             * Its inputs are the inputs of this body followed by the derivative with respect to the output,
+             * its outputs are the derivatives with respect to the inputs.
+             * It is computed on the first call only.
+             *
+             * @param output
+             * @return
+             */
+            Derivative const & backward(size_t const output);
+
+            /** @brief Returns the body of the forward derivative of the output along the input.
+             * Its inputs are the inputs of this body followed by the derivative of the input,
+             * its single output is the derivative of the output.
+             * It is computed on the first call only.
+             *
+             * @param output
+             * @param input
+             * @return
+             */
+            Derivative const & forward(size_t const output, size_t const input);
+
+        private:
+            /** The derivatives computed so far, they are guarded by a single recursive lock for all bodies,
+             * since a body may be shared by graphs built concurrently and all derivatives of a body share its graph
+             */
+            std::unordered_map<size_t, Derivative> backward_derivatives;
+            std::unordered_map<size_t, Derivative> forward_derivatives;
+        };
+
+        /** @brief Creates a subroutine body from the computation of the outputs from the inputs in the graph
+         *
+         * @param name
+         * @param graph
+         * @param inputs
+         * @param outputs
+         * @return
+         */
+        SubRoutinePtr make_subroutine(std::string const name,
+                                      Graph const graph,
+                                      NodeVec const inputs,
+                                      NodeVec const outputs);
+    }
+}
+#endif //METADIFF_GRAPH_IR_SUBROUTINE_H
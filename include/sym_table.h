@@ -0,0 +1,155 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#ifndef METADIFF_GRAPH_IR_SYM_TABLE_H
+#define METADIFF_GRAPH_IR_SYM_TABLE_H
+
+namespace md{
+    namespace gir{
+        /** The Shape of a Node, where each dimension refers to a SymInt interned in the SymIntTable of its graph.
+         * As equal polynomials are interned only once, two SymShape from the same graph are compared
+         * only by the ids (addresses) of their dimensions.
+         */
+        class SymShape {
+        public:
+            SymShape():
+                    dims{{nullptr, nullptr, nullptr, nullptr}} {};
+
+            SymShape(std::array<SymInt const *, 4> const dims):
+                    dims(dims) {};
+
+            /** @brief Returns whether the shape has not been set
+             *
+             * @return
+             */
+            bool empty() const {
+                return dims[0] == nullptr;
+            }
+
+            SymInt const & operator[](size_t const index) const {
+                return *dims[index];
+            }
+
+            /** @brief Returns the id of the interned SymInt at the index, which is unique for each value in a graph
+             *
+             * @param index
+             * @return
+             */
+            SymInt const * id(size_t const index) const {
+                return dims[index];
+            }
+
+            /** @brief Replaces the dimension at the index with an already interned SymInt
+             *
+             * @param index
+             * @param value
+             */
+            void set(size_t const index, SymInt const * value) {
+                dims[index] = value;
+            }
+
+            operator Shape() const {
+                return Shape{*dims[0], *dims[1], *dims[2], *dims[3]};
+            }
+
+            bool operator==(SymShape const & other) const {
+                return dims == other.dims;
+            }
+
+            bool operator!=(SymShape const & other) const {
+                return dims != other.dims;
+            }
+
+        private:
+            std::array<SymInt const *, 4> dims;
+        };
+
+        inline bool operator==(SymShape const & shape1, Shape const & shape2){
+            for(auto i = 0; i < 4; ++i){
+                if(shape1[i] != shape2[i]){
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        inline bool operator==(Shape const & shape1, SymShape const & shape2){
+            return shape2 == shape1;
+        }
+
+        inline bool operator!=(SymShape const & shape1, Shape const & shape2){
+            return not (shape1 == shape2);
+        }
+
+        inline bool operator!=(Shape const & shape1, SymShape const & shape2){
+            return not (shape2 == shape1);
+        }
+
+        /**
+         * A per graph interning table of SymInt values. Each distinct polynomial is stored only once,
+         * at a stable address which serves as its id, so that nodes with equal dimensions share
+         * the same representation and equality checks reduce to comparing ids.
+         */
+        class SymIntTable {
+        public:
+            SymIntTable();
+
+            SymIntTable(SymIntTable const & table) = delete;
+
+            /** @brief Returns the number of distinct values in the table
+             *
+             * @return
+             */
+            size_t size() const {
+                return values.size();
+            }
+
+            /** @brief Returns the id of the value, adding it to the table if it is not there
+             *
+             * @param value
+             * @return
+             */
+            SymInt const * intern(SymInt const & value);
+
+            /** @brief Interns all of the dimensions of the shape
+             *
+             * @param shape
+             * @return
+             */
+            SymShape intern(Shape const & shape);
+
+            /** @brief Returns the id of the value 1
+             *
+             * @return
+             */
+            SymInt const * one() const {
+                return unit;
+            }
+
+            /** @brief Returns the interned shape (1, 1, 1, 1) of scalars
+             *
+             * @return
+             */
+            SymShape scalar() const {
+                return SymShape(std::array<SymInt const *, 4>{{unit, unit, unit, unit}});
+            }
+
+        private:
+            /** The distinct values, a deque never moves its elements */
+            std::deque<SymInt> values;
+            /** Mapping a structural hash to the values with that hash */
+            std::unordered_multimap<size_t, SymInt const *> index;
+            /** The id of the value 1 */
+            SymInt const * unit;
+
+            /** @brief Computes a hash from the monomials of the value
+             *
+             * @param value
+             * @return
+             */
+            static size_t hash(SymInt const & value);
+        };
+    }
+}
+#endif //METADIFF_GRAPH_IR_SYM_TABLE_H
@@ -14,7 +14,7 @@ namespace md{
         inline LogSink gir_sink(){
             static LogSink gir_sink;
             if(not gir_sink){
-                gir_sink = std::make_shared<spdlog::sinks::dist_sink_st>();
+                gir_sink = std::make_shared<spdlog::sinks::dist_sink_mt>();
             }
             return gir_sink;
         }
@@ -104,6 +104,14 @@ namespace md{
          */
         Node get_base_node(Node const node);
 
+        /** @brief Evaluates whether the node is a ConstantValue of the value, skipping any Alias or Broadcast parents
+         *
+         * @param node
+         * @param value
+         * @return
+         */
+        bool is_constant_value(Node const node, double const value);
+
         /** @brief Evaluates whether the two nodes are symbolically equals
          *
          * @param node1
@@ -120,7 +128,7 @@ namespace md{
          * @param op_name
          * @return
          */
-        Shape get_max_shape(NodeVec const & nodes, std::string const op_name);
+        SymShape get_max_shape(NodeVec const & nodes, std::string const op_name);
 
         /** @brief If the input Node matches the Shape does nothing. Otherwise broadcasts the Node to the shape
          * or throws an exception based on the Node's Graph policy for implicit_broadcast.
@@ -132,6 +140,16 @@ namespace md{
          */
         Node implicit_broadcast(Node const node, Shape const shape, std::string const op_name);
 
+        /** @brief Same as implicit_broadcast(), but for an interned shape of the Node's Graph,
+         * such that the shapes are compared only by the ids of their dimensions.
+         *
+         * @param node
+         * @param shape
+         * @param op_name
+         * @return
+         */
+        Node implicit_broadcast(Node const node, SymShape const shape, std::string const op_name);
+
         /** @brief Get's the maximum shape from all nodes (see get_max_shape()) and than broadcasts each node
          * to that shape or throws an exception (see implicit_broadcast())
          *
@@ -183,6 +201,14 @@ namespace md{
          */
         std::vector<std::string> unique_dimensions(Graph graph);
 
+        /** @brief Returns the unique single integers that are part of shapes of the masked nodes of the graph
+         *
+         * @param graph
+         * @param mask
+         * @return
+         */
+        std::vector<std::string> unique_dimensions(Graph graph, NodeSet const & mask);
+
         /** @brief Verifies that the input_shapes have consistent shapes.
          * If they are the same as last_shapes directly return.
          * If not using the corresponding symbolic_inputs and the other implicit values provided
@@ -5,6 +5,7 @@
 #ifndef METADIFF_GRAPH_IR_BACKEND_MOCK_H
 #define METADIFF_GRAPH_IR_BACKEND_MOCK_H
 
+#include "unordered_set"
 #include "graph_ir.h"
 
 namespace md{
@@ -55,14 +56,15 @@ namespace md{
             class MockMemoryManager : public AbstractMemoryManager {
             public:
                 void *memory;
-                std::unordered_map<size_t, std::pair<SymInt, SymInt>> abstract_map;
+                /** The placement of each buffer in the pool, as the buffer_offset and buffer_size */
+                std::unordered_map<size_t, ExecutionData> abstract_map;
                 std::unordered_map<size_t, std::pair<int64_t , int64_t >> current_map;
                 int64_t current_size;
 
                 MockMemoryManager(): current_size(0) {};
 
-                void set_entry(size_t id, SymInt offset, SymInt size) {
-                    abstract_map[id] = {offset, size};
+                void set_entry(size_t id, ExecutionData const & execution) {
+                    abstract_map[id] = execution;
                 }
 
                 void* get(size_t id) {
@@ -74,10 +76,12 @@ namespace md{
                 }
 
                 void calculate_exact_map(std::unordered_map<std::string, int64_t > const & provided){
+                    // Buffers may share memory, so the pool ends with the last of them
                     current_size = 0;
                     for(auto i=abstract_map.begin(); i != abstract_map.end(); ++i){
-                        current_map[i->first] = {i->second.first.eval(provided), i->second.second.eval(provided)};
-                        current_size += current_map[i->first].second;
+                        current_map[i->first] = {i->second.buffer_offset.eval(provided),
+                                                 i->second.buffer_size.eval(provided)};
+                        current_size = std::max(current_size, current_map[i->first].first + current_map[i->first].second);
                     }
                 }
             };
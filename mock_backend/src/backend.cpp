@@ -58,7 +58,7 @@ namespace md{
 
             void AbstractMockFunction::initialize(ImplicitValues const & provided) {
                 auto deduced = sym::deduce_values(provided);
-                auto ps = gf.graph->op_map["Parameter"];
+                auto ps = gf.op_nodes(OpKind::Parameter);
                 std::array<long, 4> shape;
                 for(auto i=0; i<ps.size(); ++i){
                     auto cast_op = std::dynamic_pointer_cast<op::Parameter>(ps[i]->op);
@@ -9,6 +9,9 @@ typedef std::unordered_map<size_t, RepFunc> RepMap;
 namespace md {
     namespace backend {
         namespace mock {
+            bool is_monitor(OpKind const kind);
+            std::unordered_map<size_t, ExecutionData> allocate_buffers(GraphFunction const & gf);
+
             std::shared_ptr<AbstractMockFunction> MockBackend::make_source_gen_function(GraphFunction const &gf){
                 generate_sources(gf);
                 compile(gf);
@@ -16,20 +19,14 @@ namespace md {
                 auto func_ptr = std::make_shared<symbol>(dll_path, RTLD_LAZY, "eval");
                 // Build the memory manager
                 auto manager = std::make_shared<MockMemoryManager>();
-                SymInt bytes, offset = 0;
-                for(auto i=0; i<gf.graph->nodes.size(); ++i){
-                    auto node = gf.graph->nodes[i];
-                    if(node->op->name != "Input" and node->op->name != "Parameter" and node->op->name != "Monitor"){
-                        auto is_out = std::find_if(gf.outputs.begin(),
-                                                   gf.outputs.end(),
-                                                   [=](Node n){return n->id == node->id;});
-                        if(is_out == gf.outputs.end()){
-                            bytes = number_of_elements(node->shape) * byte_size(node->data_type);
-                            manager->set_entry(node->id, offset, bytes);
-                            offset = offset + bytes;
-                        }
-                    }
+                std::unordered_set<size_t> slots;
+                auto const execution = allocate_buffers(gf);
+                for(auto i=execution.begin(); i != execution.end(); ++i){
+                    manager->set_entry(i->first, i->second);
+                    slots.insert(i->second.buffer_id);
                 }
+                backend_logger(name)->debug("Allocated {} buffers of {} in {} slots of memory",
+                                            execution.size(), gf.name, slots.size());
                 return std::make_shared<MockSourceGenFunction>(shared_from_this(), gf, func_ptr, manager);
             };
 
@@ -59,10 +56,30 @@ namespace md {
                 }
             }
 
+            bool is_monitor(OpKind const kind){
+                switch (kind) {
+                    case OpKind::Print:
+                    case OpKind::Retrieve:
+                    case OpKind::LogToFile:
+                    case OpKind::Guard: return true;
+                    default: return false;
+                }
+            }
+
             std::string to_code(DataType data_type);
             RepFunc build_rep(Node node, std::string name = "");
             void write_api(std::ostream &f);
+            void write_main(std::ostream &f);
             void write_op(Operator op, RepMap &repmap, std::ostream &f);
+            void write_call(NodeVec const & calls, RepMap &repmap, std::ostream &f);
+            NodeVec sibling_calls(GraphFunction const & gf, Node const call);
+            std::string write_expression(Operator op, RepMap &repmap, std::vector<std::string> &iters);
+            bool is_passive(OpKind const kind);
+            std::vector<NodeVec> fusion_groups(NodeVec const & nodes);
+            std::vector<bool> stored_members(GraphFunction const & gf, NodeVec const & group);
+            void write_nodes(GraphFunction const & gf, NodeVec const & nodes, RepMap &repmap,
+                             std::function<void(Node)> const & declare, std::ostream &f);
+            void write_kernels(NodeVec const & calls, std::unordered_set<size_t> & written, std::ostream &f);
 
             void MockBackend::generate_sources(GraphFunction const & gf) const {
                 auto source_dir = this->source_dir / gf.name;
@@ -74,6 +91,9 @@ namespace md {
                 std::ofstream f;
                 f.open(source_path.string());
                 write_api(f);
+                std::unordered_set<size_t> written;
+                write_kernels(gf.op_nodes(OpKind::SubRoutine), written, f);
+                write_main(f);
                 RepMap repmap;
                 // Generate symbolic expressions
                 f << "\t// Generating symbolic expressions" << std::endl;
@@ -89,7 +109,7 @@ namespace md {
                 }
                 // Generate parameters representation
                 f << "\t// Generating parameter expressions" << std::endl;
-                auto params = gf.graph->op_map["Parameter"];
+                auto params = gf.op_nodes(OpKind::Parameter);
                 for (auto i = 0; i < params.size(); ++i) {
                     f << "\tauto node_" << params[i]->id << " = params[" << i << "]->get<"
                       << to_code(params[i]->data_type) << ">();" << std::endl;
@@ -105,39 +125,41 @@ namespace md {
                       << sym::to_code(gf.outputs[i]->shape[2], print_str) << ", "
                       << sym::to_code(gf.outputs[i]->shape[3], print_str) << "}));\n";
                     f << "\tauto node_" << gf.outputs[i]->id << " = outputs[" << i << "]->get<"
-                      << to_code(params[i]->data_type) << ">();" << std::endl;
+                      << to_code(gf.outputs[i]->data_type) << ">();" << std::endl;
                     repmap.insert({gf.outputs[i]->id, build_rep(gf.outputs[i])});
                 }
                 // Generate monitors
                 f << "\t// Generating monitor expressions" << std::endl;
-                auto m = gf.graph->op_map.find("Monitor");
-                auto monitors = (m == gf.graph->op_map.end()) ? NodeVec{} : m->second;
+                NodeVec monitors;
+                for (auto kind: {OpKind::Print, OpKind::Retrieve, OpKind::LogToFile, OpKind::Guard}) {
+                    auto m = gf.op_nodes(kind);
+                    monitors.insert(monitors.end(), m.begin(), m.end());
+                }
                 f << "\tVarVec monitors;\n";
                 for (auto i = 0; i < monitors.size(); ++i) {
-                    f << "\toutputs.push_back(std::make_shared<MockStorage>(f32, std::array<long, 4> {"
-                      << sym::to_code(gf.outputs[i]->shape[0], print_str) << ", "
-                      << sym::to_code(gf.outputs[i]->shape[1], print_str) << ", "
-                      << sym::to_code(gf.outputs[i]->shape[2], print_str) << ", "
-                      << sym::to_code(gf.outputs[i]->shape[3], print_str) << "}));\n";
+                    f << "\tmonitors.push_back(make_var(" << monitors[i]->data_type << ", std::array<long, 4> {"
+                      << sym::to_code(monitors[i]->shape[0], print_str) << ", "
+                      << sym::to_code(monitors[i]->shape[1], print_str) << ", "
+                      << sym::to_code(monitors[i]->shape[2], print_str) << ", "
+                      << sym::to_code(monitors[i]->shape[3], print_str) << "}));\n";
                     f << "\tauto node_" << monitors[i]->id << " = monitors[" << i << "]->get<"
                       << to_code(monitors[i]->data_type) << ">();" << std::endl;
                     repmap.insert({monitors[i]->id, build_rep(monitors[i])});
                 }
                 // Generate all nodes
-                for (auto i = 0; i < gf.graph->nodes.size(); ++i) {
-                    auto node = gf.graph->nodes[i];
-                    if (node->op->name != "Input" and node->op->name != "Parameter") {
+                write_nodes(gf, gf.nodes(), repmap, [&](Node node) {
+                    // The nodes writing no code have no storage of their own
+                    if (not is_passive(node->op->kind)) {
                         auto is_out = std::find_if(gf.outputs.begin(),
                                                    gf.outputs.end(),
                                                    [=](Node n){return n->id == node->id;});
-                        if(is_out == gf.outputs.end()) {
-                            f << "\tauto node_" << node->id << " = static_cast<" << to_code(gf.graph->nodes[i]->data_type)
+                        if(is_out == gf.outputs.end() and not is_monitor(node->op->kind)) {
+                            f << "\tauto node_" << node->id << " = static_cast<" << to_code(node->data_type)
                               << "*>(manager->get(" << node->id << "));" << std::endl;
                             repmap.insert({node->id, build_rep(node)});
                         }
-                        write_op(gf.graph->nodes[i]->op, repmap, f);
                     }
-                }
+                }, f);
                 f << "\treturn {outputs, monitors};" << std::endl << "};" << std::endl << std::endl;
                 f.close();
                 backend_logger(name)->debug("Generating {} completed.", source_path.string());
@@ -147,19 +169,33 @@ namespace md {
                 auto result = op->result;
                 std::string tabs = "\t";
                 std::vector<std::string> iters{"it0", "it1", "it2", "it3"};
-                if(op->name == "Input" or op->name == "Parameter"){
-                    return;
-                }
-                if(op->name == "Broadcast") {
-                    repmap[result->id] = repmap[op->get_parents()[0]->id];
-                    return;
-                }
-                if(op->name == "SymIntWrapper") {
-                    auto cast_op = std::dynamic_pointer_cast<op::SymIntWrapper>(op);
-                    repmap[result->id] = [=](std::vector<std::string> &it) {
-                        return "(" + sym::to_code(cast_op->value, print_str) + ")";
-                    };
-                    return;
+                switch (op->kind) {
+                    case OpKind::Input:
+                    case OpKind::Parameter: return;
+                    case OpKind::Alias:
+                    case OpKind::Broadcast: {
+                        repmap[result->id] = repmap[op->parents_view()[0]->id];
+                        return;
+                    }
+                    case OpKind::SymIntWrapper: {
+                        auto cast_op = std::dynamic_pointer_cast<op::SymIntWrapper>(op);
+                        repmap[result->id] = [=](std::vector<std::string> &it) {
+                            return "(" + sym::to_code(cast_op->value, print_str) + ")";
+                        };
+                        return;
+                    }
+                    case OpKind::ConstantValue: {
+                        auto cast_op = std::dynamic_pointer_cast<op::ConstantValue>(op);
+                        repmap[result->id] = [=](std::vector<std::string> &it) {
+                            return "(" + fmt::format("{}", cast_op->value) + ")";
+                        };
+                        return;
+                    }
+                    case OpKind::SubRoutine: {
+                        write_call(NodeVec{result}, repmap, f);
+                        return;
+                    }
+                    default: break;
                 }
                 // Write loop start
                 f << tabs << "// " << result << std::endl;
@@ -170,47 +206,462 @@ namespace md {
                       << " ++it" << i << "){" << std::endl;
                     tabs += "\t";
                 }
-                if (op->name == "Add") {
-                    auto cast_op = std::dynamic_pointer_cast<op::Add>(op);
-                    auto parents = cast_op->get_parents();
-                    f << tabs << repmap[result->id](iters) << " = (0";
-                    for (auto i = 0; i < parents.size(); ++i) {
-                        if (not cast_op->neg[i]) {
-                            f << " + " << repmap[parents[i]->id](iters);
+                auto const expression = write_expression(op, repmap, iters);
+                if (not expression.empty()) {
+                    f << tabs << repmap[result->id](iters) << " = " << expression << ";" << std::endl;
+                }
+                // Write loop end
+                for (auto i = 0; i < result.order(); ++i) {
+                    tabs = tabs.substr(0, tabs.length() - 1);
+                    f << tabs << "}" << std::endl;
+                }
+            }
+
+            /** Writes a single call of the kernel of the body, computing the outputs of all of the calls, which
+             * must be of the same body on the same arguments (see sibling_calls()) */
+            void write_call(NodeVec const & calls, RepMap &repmap, std::ostream &f) {
+                Node const result = calls[0];
+                auto cast_op = std::dynamic_pointer_cast<op::SubRoutine>(result->op);
+                auto const args = cast_op->parents_view();
+                std::string tabs = "\t";
+                std::vector<std::string> iters{"it0", "it1", "it2", "it3"};
+                f << tabs << "//";
+                for (auto const & call: calls) {
+                    f << " " << call;
+                }
+                f << std::endl;
+                std::vector<std::string> names;
+                for (auto i = 0; i < args.size(); ++i) {
+                    auto const kind = args[i]->op->kind;
+                    if (kind == OpKind::Alias or kind == OpKind::Broadcast or kind == OpKind::SymIntWrapper or
+                        kind == OpKind::ConstantValue) {
+                        // These have no storage of their own, so they are written into a temporary
+                        auto const name = "arg_" + std::to_string(result->id) + "_" + std::to_string(i);
+                        f << tabs << "std::vector<" << to_code(args[i]->data_type) << "> " << name << "("
+                          << sym::to_code(number_of_elements(args[i]->shape), print_str) << ");" << std::endl;
+                        auto const rep = build_rep(args[i], name);
+                        for (auto j = 0; j < args[i].order(); ++j) {
+                            f << tabs << "for(auto it" << j << "=0;"
+                              << " it" << j << "<(" << sym::to_code(args[i]->shape[j], print_str) << ");"
+                              << " ++it" << j << "){" << std::endl;
                         }
-                    }
-                    f << ") - (0";
-                    for (auto i = 0; i < parents.size(); ++i) {
-                        if (cast_op->neg[i]) {
-                            f << " + " << repmap[parents[i]->id](iters);
+                        f << tabs << rep(iters) << " = " << repmap[args[i]->id](iters) << ";" << std::endl;
+                        for (auto j = 0; j < args[i].order(); ++j) {
+                            f << tabs << "}" << std::endl;
                         }
+                        names.push_back(name + ".data()");
+                    } else {
+                        names.push_back("node_" + std::to_string(args[i]->id));
+                    }
+                }
+                // The outputs which none of the calls use are not requested
+                std::vector<std::string> outputs(cast_op->body->function.outputs.size(), "nullptr");
+                for (auto const & call: calls) {
+                    auto const output = std::dynamic_pointer_cast<op::SubRoutine>(call->op)->output;
+                    outputs[output] = "node_" + std::to_string(call->id);
+                }
+                f << tabs << "subroutine_" << cast_op->body->id << "(";
+                for (auto i = 0; i < names.size(); ++i) {
+                    f << names[i] << ", ";
+                }
+                for (auto i = 0; i < outputs.size(); ++i) {
+                    f << outputs[i] << ", ";
+                }
+                f << "deduced);" << std::endl;
+            }
+
+            /** Returns the calls of the same body on the same arguments as the call, in order. Each of them
+             * results in a different output of the body, so they are all computed by the first one. */
+            NodeVec sibling_calls(GraphFunction const & gf, Node const call) {
+                auto cast_op = std::dynamic_pointer_cast<op::SubRoutine>(call->op);
+                auto const args = cast_op->parents_view();
+                if (args.empty()) {
+                    return NodeVec{call};
+                }
+                NodeVec calls;
+                for (auto const child: gf.graph->edges.children(args[0].id)) {
+                    Node const node = gf.graph->nodes[child];
+                    if (not gf.members[child] or node->op->kind != OpKind::SubRoutine or
+                        (not calls.empty() and calls.back().id == child)) {
+                        continue;
+                    }
+                    auto other = std::dynamic_pointer_cast<op::SubRoutine>(node->op);
+                    auto const other_args = other->parents_view();
+                    if (other->body != cast_op->body or other_args.size() != args.size()) {
+                        continue;
+                    }
+                    bool same = true;
+                    for (auto i = 0; i < args.size() and same; ++i) {
+                        same = other_args[i].id == args[i].id;
                     }
-                    f << ");" << std::endl;
-//                    f << "std::cout << " << repmap[result->id](iters) << " << std::endl;" << std::endl;
-                } else if (op->name == "Mul"){
-                    auto cast_op = std::dynamic_pointer_cast<op::Mul>(op);
-                    auto parents = cast_op->get_parents();
-                    f << tabs << repmap[result->id](iters) << " = (1";
-                    for (auto i = 0; i < parents.size(); ++i) {
-                        if (not cast_op->div[i]) {
-                            f << " * " << repmap[parents[i]->id](iters);
+                    if (same) {
+                        calls.push_back(node);
+                    }
+                }
+                return calls;
+            }
+
+            /** Returns the expression computing a single element of the node, or an empty string if the operator
+             * is not supported */
+            std::string write_expression(Operator op, RepMap &repmap, std::vector<std::string> &iters) {
+                std::string expression;
+                switch (op->kind) {
+                    case OpKind::Add: {
+                        auto cast_op = std::dynamic_pointer_cast<op::Add>(op);
+                        auto const parents = cast_op->parents_view();
+                        expression = "(0";
+                        for (auto i = 0; i < parents.size(); ++i) {
+                            if (not cast_op->neg[i]) {
+                                expression += " + " + repmap[parents[i]->id](iters);
+                            }
                         }
+                        expression += ") - (0";
+                        for (auto i = 0; i < parents.size(); ++i) {
+                            if (cast_op->neg[i]) {
+                                expression += " + " + repmap[parents[i]->id](iters);
+                            }
+                        }
+                        expression += ")";
+                        break;
                     }
-                    f << ") / (1";
-                    for (auto i = 0; i < parents.size(); ++i) {
-                        if (cast_op->div[i]) {
-                            f << " * " << repmap[parents[i]->id](iters);
+                    case OpKind::Mul: {
+                        auto cast_op = std::dynamic_pointer_cast<op::Mul>(op);
+                        auto const parents = cast_op->parents_view();
+                        expression = "(1";
+                        for (auto i = 0; i < parents.size(); ++i) {
+                            if (not cast_op->div[i]) {
+                                expression += " * " + repmap[parents[i]->id](iters);
+                            }
+                        }
+                        expression += ") / (1";
+                        for (auto i = 0; i < parents.size(); ++i) {
+                            if (cast_op->div[i]) {
+                                expression += " * " + repmap[parents[i]->id](iters);
+                            }
                         }
+                        expression += ")";
+                        break;
                     }
-                    f << ");" << std::endl;
-//                    f << "std::cout << " << repmap[result->id](iters) << " << std::endl;" << std::endl;
+                    case OpKind::Print:
+                    case OpKind::Retrieve:
+                    case OpKind::LogToFile:
+                    case OpKind::Guard: {
+                        // Monitors pass their anchor through unchanged
+                        expression = repmap[op->parents_view()[0]->id](iters);
+                        break;
+                    }
+                    default: break;
                 }
-                // Write loop end
-                for (auto i = 0; i < result.order(); ++i) {
+                return expression;
+            }
+
+            /** Whether write_op() writes the operator as a single expression per element */
+            bool is_fusible(OpKind const kind){
+                return kind == OpKind::Add or kind == OpKind::Mul;
+            }
+
+            /** Whether write_op() writes no code for the operator, only its representation */
+            bool is_passive(OpKind const kind){
+                switch (kind) {
+                    case OpKind::Input:
+                    case OpKind::Parameter:
+                    case OpKind::Alias:
+                    case OpKind::Broadcast:
+                    case OpKind::SymIntWrapper:
+                    case OpKind::ConstantValue: return true;
+                    default: return false;
+                }
+            }
+
+            /** Splits the nodes, apart from the ones writing no code, into the loop nests written by write_nodes()
+             * in order. Consecutive elementwise nodes of the same shape share a single loop nest. */
+            std::vector<NodeVec> fusion_groups(NodeVec const & nodes) {
+                std::vector<NodeVec> groups;
+                bool open = false;
+                for (auto i = 0; i < nodes.size(); ++i) {
+                    Node const node = nodes[i];
+                    if (is_passive(node->op->kind)) {
+                        continue;
+                    }
+                    bool const fusible = is_fusible(node->op->kind);
+                    if (open and fusible and groups.back()[0]->shape == node->shape) {
+                        groups.back().push_back(node);
+                    } else {
+                        groups.push_back(NodeVec{node});
+                    }
+                    open = fusible;
+                }
+                return groups;
+            }
+
+            /** Returns for each node of the group whether its value is written to its storage, which is the case
+             * for outputs and nodes used outside of the group, or if the group is a single node */
+            std::vector<bool> stored_members(GraphFunction const & gf, NodeVec const & group) {
+                if (group.size() == 1) {
+                    return {true};
+                }
+                std::unordered_set<size_t> members;
+                for (auto const & node: group) {
+                    members.insert(node->id);
+                }
+                std::vector<bool> stored;
+                for (auto const & node: group) {
+                    bool escaping = std::find_if(gf.outputs.begin(), gf.outputs.end(),
+                                                 [&](Node n){return n->id == node->id;}) != gf.outputs.end();
+                    for (auto const child: gf.graph->edges.children(node.id)) {
+                        escaping = escaping or (gf.members[child] and members.count(child) == 0);
+                    }
+                    stored.push_back(escaping);
+                }
+                return stored;
+            }
+
+            /** Writes a group of elementwise nodes of the same shape as a single loop nest. Each value is kept in
+             * a local variable and only the values which are outputs or are used outside of the group are
+             * declared (see write_nodes()) and written to their storage. */
+            void write_fused(GraphFunction const & gf, NodeVec const & group, RepMap &repmap,
+                             std::function<void(Node)> const & declare, std::ostream &f) {
+                auto const stored = stored_members(gf, group);
+                for (auto i = 0; i < group.size(); ++i) {
+                    if (stored[i]) {
+                        declare(group[i]);
+                    }
+                }
+                Node const first = group[0];
+                std::string tabs = "\t";
+                std::vector<std::string> iters{"it0", "it1", "it2", "it3"};
+                f << tabs << "// Fused";
+                for (auto const & node: group) {
+                    f << " " << node;
+                }
+                f << std::endl;
+                for (auto i = 0; i < first.order(); ++i) {
+                    f << tabs << "for(auto it" << i << "=0;"
+                      << " it" << i << "<(" << sym::to_code(first->shape[i], print_str) << ");"
+                      << " ++it" << i << "){" << std::endl;
+                    tabs += "\t";
+                }
+                RepMap storage;
+                for (auto i = 0; i < group.size(); ++i) {
+                    Node const node = group[i];
+                    std::string const value = "value_" + std::to_string(node->id);
+                    f << tabs << to_code(node->data_type) << " " << value << " = "
+                      << write_expression(node->op, repmap, iters) << ";" << std::endl;
+                    storage[node->id] = repmap[node->id];
+                    if (stored[i]) {
+                        f << tabs << storage[node->id](iters) << " = " << value << ";" << std::endl;
+                    }
+                    // The later nodes of the group use the local variable
+                    repmap[node->id] = [=](std::vector<std::string> &) { return value; };
+                }
+                for (auto i = 0; i < first.order(); ++i) {
                     tabs = tabs.substr(0, tabs.length() - 1);
                     f << tabs << "}" << std::endl;
                 }
+                for (auto const & node: group) {
+                    repmap[node->id] = storage[node->id];
+                }
+            }
+
+            /** Writes the nodes in order, calling declare on each node before the code using its storage.
+             * The groups of fusion_groups() with more than one node are written by write_fused(). */
+            void write_nodes(GraphFunction const & gf, NodeVec const & nodes, RepMap &repmap,
+                             std::function<void(Node)> const & declare, std::ostream &f) {
+                auto const groups = fusion_groups(nodes);
+                auto group = groups.begin();
+                size_t position = 0;
+                for (auto i = 0; i < nodes.size(); ++i) {
+                    Node const node = nodes[i];
+                    if (node->op->kind == OpKind::SubRoutine) {
+                        // The later calls are computed by the first one
+                        auto const calls = sibling_calls(gf, node);
+                        if (calls[0].id == node.id) {
+                            for (auto const & call: calls) {
+                                declare(call);
+                            }
+                            write_call(calls, repmap, f);
+                        }
+                    } else if (is_passive(node->op->kind) or group->size() == 1) {
+                        declare(node);
+                        write_op(node->op, repmap, f);
+                    } else {
+                        // The nodes in between may refer to it before it is written
+                        repmap.insert({node->id, build_rep(node)});
+                        if (position + 1 == group->size()) {
+                            write_fused(gf, *group, repmap, declare, f);
+                        }
+                    }
+                    if (not is_passive(node->op->kind) and ++position == group->size()) {
+                        ++group;
+                        position = 0;
+                    }
+                }
+            }
+
+            /** Whether the size is no larger than the other one for any values of the symbolic variables */
+            bool fits(SymInt const & size, SymInt const & other) {
+                SymInt const difference = other - size;
+                for (auto m = 0; m < difference.monomials.size(); ++m) {
+                    if (difference.monomials[m].coefficient < 0) {
+                        return false;
+                    }
+                }
+                return true;
             }
+
+            /** Assigns the offsets in the memory pool of the nodes stored by the generated code. The buffers are
+             * live from the loop nest (see fusion_groups()) computing them until the last one reading them, and the
+             * ones which are never live at the same time share memory. The lifespan is the index of the first loop
+             * nest after the last use. */
+            std::unordered_map<size_t, ExecutionData> allocate_buffers(GraphFunction const & gf) {
+                auto const groups = fusion_groups(gf.nodes());
+                // The loop nest computing each node and the nodes which need their own storage, in order
+                std::unordered_map<size_t, size_t> step;
+                NodeVec buffers;
+                for (auto g = 0; g < groups.size(); ++g) {
+                    auto const stored = stored_members(gf, groups[g]);
+                    for (auto i = 0; i < groups[g].size(); ++i) {
+                        Node const node = groups[g][i];
+                        // The later calls of a body are written together with the first one
+                        step[node->id] = node->op->kind == OpKind::SubRoutine ?
+                                         step[sibling_calls(gf, node)[0]->id] : g;
+                        auto const is_out = std::find_if(gf.outputs.begin(), gf.outputs.end(),
+                                                         [=](Node n){return n->id == node->id;});
+                        if (stored[i] and is_out == gf.outputs.end() and not is_monitor(node->op->kind)) {
+                            buffers.push_back(node);
+                        }
+                    }
+                }
+                // The last loop nest reading the storage, which the nodes writing no code refer to
+                std::function<size_t(Node)> last_use = [&](Node const node) {
+                    size_t last = step.count(node->id) ? step[node->id] : 0;
+                    for (auto const child: gf.graph->edges.children(node.id)) {
+                        if (gf.members[child]) {
+                            last = std::max(last, is_passive(gf.graph->nodes[child]->op->kind) ?
+                                                  last_use(gf.graph->nodes[child]) : step[child]);
+                        }
+                    }
+                    return last;
+                };
+                // Greedy interval coloring - each slot of the pool is reused by any later buffer which starts
+                // after the slot is released and whose size is known to be no larger than it
+                std::vector<SymInt> offsets, sizes;
+                std::vector<size_t> released;
+                SymInt total = 0;
+                std::unordered_map<size_t, ExecutionData> execution;
+                for (auto const & node: buffers) {
+                    ExecutionData data;
+                    data.buffer_size = number_of_elements(node->shape) * byte_size(node->data_type);
+                    data.lifespan = last_use(node) + 1;
+                    size_t slot = sizes.size();
+                    for (auto j = 0; j < sizes.size(); ++j) {
+                        // Takes the smallest of the free slots it fits in
+                        if (released[j] <= step[node->id] and fits(data.buffer_size, sizes[j])
+                            and (slot == sizes.size() or fits(sizes[j], sizes[slot]))) {
+                            slot = j;
+                        }
+                    }
+                    if (slot == sizes.size()) {
+                        offsets.push_back(total);
+                        sizes.push_back(data.buffer_size);
+                        released.push_back(0);
+                        total = total + data.buffer_size;
+                    }
+                    released[slot] = data.lifespan;
+                    data.buffer_id = slot;
+                    data.buffer_offset = offsets[slot];
+                    execution[node->id] = data;
+                }
+                return execution;
+            }
+
+            void write_kernels(NodeVec const & calls, std::unordered_set<size_t> & written, std::ostream &f) {
+                for (auto c = 0; c < calls.size(); ++c) {
+                    auto const body = std::dynamic_pointer_cast<op::SubRoutine>(calls[c]->op)->body;
+                    if (not written.insert(body->id).second) {
+                        continue;
+                    }
+                    GraphFunction const & gf = body->function;
+                    // The kernels called from the body are written before it
+                    write_kernels(gf.op_nodes(OpKind::SubRoutine), written, f);
+                    f << "// Kernel of the subroutine " << body->name << std::endl;
+                    f << "static void subroutine_" << body->id << "(";
+                    for (auto i = 0; i < gf.inputs.size(); ++i) {
+                        f << to_code(gf.inputs[i]->data_type) << " * in_" << i << ", ";
+                    }
+                    for (auto i = 0; i < gf.outputs.size(); ++i) {
+                        f << to_code(gf.outputs[i]->data_type) << " * out_" << i << ", ";
+                    }
+                    f << "std::unordered_map<std::string, int64_t> & deduced) {" << std::endl;
+                    for (auto i = gf.unique_symbolics.begin(); i != gf.unique_symbolics.end(); ++i) {
+                        f << "\tint64_t " << (*i) << " = deduced[\"" << (*i) << "\"];" << std::endl;
+                    }
+                    RepMap repmap;
+                    std::unordered_set<size_t> declared;
+                    for (auto i = 0; i < gf.inputs.size(); ++i) {
+                        f << "\tauto node_" << gf.inputs[i]->id << " = in_" << i << ";" << std::endl;
+                        repmap.insert({gf.inputs[i]->id, build_rep(gf.inputs[i])});
+                        declared.insert(gf.inputs[i]->id);
+                    }
+                    // The outputs which are not requested by the call site are computed in temporaries
+                    for (auto i = 0; i < gf.outputs.size(); ++i) {
+                        Node const out = gf.outputs[i];
+                        if (declared.insert(out->id).second) {
+                            f << "\tstd::vector<" << to_code(out->data_type) << "> buffer_" << out->id
+                              << "(out_" << i << " != nullptr ? 0 : "
+                              << sym::to_code(number_of_elements(out->shape), print_str) << ");" << std::endl;
+                            f << "\tauto node_" << out->id << " = out_" << i << " != nullptr ? out_" << i
+                              << " : buffer_" << out->id << ".data();" << std::endl;
+                            repmap.insert({out->id, build_rep(out)});
+                        }
+                    }
+                    write_nodes(gf, gf.nodes(), repmap, [&](Node node) {
+                        // The nodes writing no code have no storage of their own
+                        if (not is_passive(node->op->kind) and declared.insert(node->id).second) {
+                            f << "\tstd::vector<" << to_code(node->data_type) << "> buffer_" << node->id << "("
+                              << sym::to_code(number_of_elements(node->shape), print_str) << ");" << std::endl;
+                            f << "\tauto node_" << node->id << " = buffer_" << node->id << ".data();" << std::endl;
+                            repmap.insert({node->id, build_rep(node)});
+                        }
+                    }, f);
+                    // Outputs writing no code only have a representation, so it is evaluated into their storage
+                    std::vector<std::string> iters{"it0", "it1", "it2", "it3"};
+                    for (auto i = 0; i < gf.outputs.size(); ++i) {
+                        Node const out = gf.outputs[i];
+                        auto const kind = out->op->kind;
+                        if (not is_passive(kind) or kind == OpKind::Input or kind == OpKind::Parameter) {
+                            continue;
+                        }
+                        std::string tabs = "\t";
+                        f << tabs << "if(out_" << i << " != nullptr){" << std::endl;
+                        for (auto j = 0; j < out.order(); ++j) {
+                            tabs += "\t";
+                            f << tabs << "for(auto it" << j << "=0;"
+                              << " it" << j << "<(" << sym::to_code(out->shape[j], print_str) << ");"
+                              << " ++it" << j << "){" << std::endl;
+                        }
+                        f << tabs << "\t" << build_rep(out)(iters) << " = " << repmap[out->id](iters) << ";"
+                          << std::endl;
+                        for (auto j = 0; j < out.order(); ++j) {
+                            f << tabs << "}" << std::endl;
+                            tabs = tabs.substr(0, tabs.length() - 1);
+                        }
+                        f << tabs << "}" << std::endl;
+                    }
+                    // Outputs which are just inputs are copied
+                    for (auto i = 0; i < gf.outputs.size(); ++i) {
+                        for (auto j = 0; j < gf.inputs.size(); ++j) {
+                            if (gf.outputs[i].id == gf.inputs[j].id) {
+                                f << "\tif(out_" << i << " != nullptr){ std::copy(in_" << j << ", in_" << j << " + "
+                                  << sym::to_code(number_of_elements(gf.inputs[j]->shape), print_str)
+                                  << ", out_" << i << "); }" << std::endl;
+                            }
+                        }
+                    }
+                    f << "}" << std::endl << std::endl;
+                }
+            }
+
             std::string to_code(DataType data_type){
                 switch (data_type.type) {
                     case BOOLEAN: return "bool";
@@ -294,6 +745,7 @@ namespace md {
                         "#include <array>\n"
                         "#include <complex>\n"
                         "#include <vector>\n"
+                        "#include <algorithm>\n"
                         "#include <iostream>\n"
                         "#include <unordered_map>\n"
                         "#include <memory>\n\n"
@@ -355,8 +807,11 @@ namespace md {
                         "\tvirtual void * get(size_t id)  = 0;\n"
                         "};\n\n"
                         "typedef std::vector<std::shared_ptr<MockStorage>> VarVec;\n"
-                        "// ***** END API DEFINITIONS *****\n\n"
-                        "// Main function\n"
+                        "// ***** END API DEFINITIONS *****\n\n";
+            }
+
+            void write_main(std::ostream &f) {
+                f << "// Main function\n"
                         "extern \"C\" std::pair<VarVec, VarVec> eval(VarVec & inputs, \n"
                         "\t\t\tVarVec & constants,\n"
                         "\t\t\tVarVec & params,\n"
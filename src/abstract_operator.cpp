@@ -7,11 +7,22 @@
 namespace md{
     namespace gir{
         namespace op{
+            void AbstractOperator::bind_inputs() const {
+                auto const parents = get_parents();
+                auto const arguments = get_arguments();
+                num_parents = static_cast<int>(parents.size());
+                num_ancestors = static_cast<int>(parents.size() + arguments.size());
+                Node * first = inline_inputs.data();
+                if (static_cast<size_t>(num_ancestors) > inline_inputs.size()) {
+                    spilled_inputs.resize(num_ancestors);
+                    first = spilled_inputs.data();
+                }
+                std::copy(parents.begin(), parents.end(), first);
+                std::copy(arguments.begin(), arguments.end(), first + num_parents);
+            }
+
             NodeVec AbstractOperator::get_ancestors() const {
-                auto ancestors = get_parents();
-                auto arguments = get_arguments();
-                std::copy (ancestors.begin(), ancestors.end(), std::back_inserter(arguments));
-                return ancestors;
+                return ancestors_view().vec();
             }
 
             NodeVec AbstractOperator::get_arguments() const {
@@ -19,9 +30,8 @@ namespace md{
             }
 
             bool AbstractOperator::is_input_dependent() const {
-                auto arguments = get_arguments();
-                for(auto i=0; i<arguments.size(); ++i){
-                    if(arguments[i]->is_input_dependent){
+                for(auto const & argument: arguments_view()){
+                    if(argument->is_input_dependent){
                         return true;
                     }
                 }
@@ -29,17 +39,53 @@ namespace md{
             }
 
             bool AbstractOperator::is_differentiable() const {
-                auto parents = get_parents();
-                for(auto i=0; i<parents.size(); ++i){
-                    if(parents[i]->is_differentiable){
+                for(auto const & parent: parents_view()){
+                    if(parent->is_differentiable){
                         return true;
                     }
                 }
                 return false;
             }
 
+            SymShape const & AbstractOperator::get_interned_shape() const {
+                if (interned_shape.empty()) {
+                    interned_shape = infer_interned_shape();
+                }
+                return interned_shape;
+            }
+
+            SymShape AbstractOperator::infer_interned_shape() const {
+                return graph->sym_table.intern(get_shape());
+            }
+
+            size_t AbstractOperator::hash() const {
+                auto const ancestors = ancestors_view();
+                size_t seed = std::hash<OpKind>()(kind);
+                for (auto i = 0; i < ancestors.size(); ++i) {
+                    seed ^= std::hash<size_t>()(ancestors[i].id) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+                }
+                return seed;
+            }
+
+            bool AbstractOperator::same_ancestors(Operator const op) const {
+                if (kind != op->kind or graph != op->graph) {
+                    return false;
+                }
+                auto const ancestors = ancestors_view();
+                auto const op_ancestors = op->ancestors_view();
+                if (ancestors.size() != op_ancestors.size()) {
+                    return false;
+                }
+                for (auto i = 0; i < ancestors.size(); ++i) {
+                    if (ancestors[i].id != op_ancestors[i].id) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
             unsigned int AbstractOperator::get_grad_level() const {
-                auto ancestors = get_ancestors();
+                auto const ancestors = ancestors_view();
                 unsigned int max_grad_level = 0;
                 for (auto i = 0; i < ancestors.size(); ++i) {
                     if (ancestors[i]->grad_level > max_grad_level) {
@@ -51,45 +97,53 @@ namespace md{
 
 
             void AbstractOperator::backward_diff(std::vector<NodeVec> & derivative_messages,
-                                                 std::vector<bool>& flow_tree) {
-                if (derivative_messages[result->id].size() == 0) {
+                                                 FlowTree const & flow_tree) {
+                auto const position = flow_tree.position(result->id);
+                if (position == FlowTree::missing or derivative_messages[position].size() == 0) {
                     return;
                 }
                 // Retrieve the gradient with respect to the output of the operator
-                Node my_grad = backward_diff_combine(derivative_messages[result->id]);
+                Node my_grad = backward_diff_combine(derivative_messages[position]);
+                // Keep only the combined message, which is the result when the node is one of the parameters
+                derivative_messages[position] = NodeVec{my_grad};
                 op_logger(name)->debug("Generating backward diff messages from node {}", result->id);
 
                 // Sets the current group to the group of the operator
                 auto old_scope = graph->scope;
                 graph->scope = result->scope;
 
-                // Update the gradient message name
-                if (my_grad->name == "Derived Node" or my_grad->name == "") {
-                    my_grad->name = "Grad of " + std::to_string(result->id) + "|";
-                } else {
-                    my_grad->name += "Grad of " + std::to_string(result->id) + "|";
+                // Update the gradient message name, unless it is an older node the message was merged with
+                if (my_grad->id >= graph->diff_start) {
+                    if (my_grad->name == "Derived Node" or my_grad->name == "") {
+                        my_grad->name = "Grad of " + std::to_string(result->id) + "|";
+                    } else {
+                        my_grad->name += "Grad of " + std::to_string(result->id) + "|";
+                    }
                 }
 
                 // This should not happen, but is here for a sanity check
-                if (not is_differentiable() or not flow_tree[result->id]) {
+                if (not is_differentiable()) {
                     throw throw_op_ige(name, "Calling backward_diff unexpectedly.");
                 }
 
-                NodeVec parents = get_parents();
+                NodeView const parents = parents_view();
                 // Compute and send gradients only to differentiable parents in the flow_tree
                 for (int i = 0; i < parents.size(); ++i) {
-                    if (parents[i]->is_differentiable and flow_tree[parents[i]->id]) {
+                    auto const parent_position = flow_tree.position(parents[i]->id);
+                    if (parents[i]->is_differentiable and parent_position != FlowTree::missing) {
                         Node parent_grad = backward_diff_parent(my_grad, i);
-                        if (parent_grad->name == "Derived Node" or parent_grad->name == "") {
-                            parent_grad->name = "Grad msg " + std::to_string(result->id) + "->"
-                                                + std::to_string(parents[i]->id) + "|";
-                        } else {
-                            parent_grad->name += "Grad msg " + std::to_string(result->id) + "->"
-                                                 + std::to_string(parents[i]->id) + "|";
+                        if (parent_grad->id >= graph->diff_start) {
+                            if (parent_grad->name == "Derived Node" or parent_grad->name == "") {
+                                parent_grad->name = "Grad msg " + std::to_string(result->id) + "->"
+                                                    + std::to_string(parents[i]->id) + "|";
+                            } else {
+                                parent_grad->name += "Grad msg " + std::to_string(result->id) + "->"
+                                                     + std::to_string(parents[i]->id) + "|";
+                            }
                         }
                         op_logger(name)->debug("Sending backward diff message with id {} from {} to {}",
                                                parent_grad->id, result->id, parents[i]->id);
-                        derivative_messages[parents[i]->id].push_back(parent_grad);
+                        derivative_messages[parent_position].push_back(parent_grad);
                     }
                 }
                 // Restore group
@@ -106,16 +160,21 @@ namespace md{
                 }
             }
 
-            void AbstractOperator::forward_diff(NodeVec & all_derivatives) {
-                if(all_derivatives[result->id].ptr.expired()){
-                    return;
-                }
+            void AbstractOperator::forward_diff(NodeVec & all_derivatives, FlowTree const & flow_tree) {
+                auto const position = flow_tree.position(result->id);
 
-                // Retrieve the derivatives of all of the parents
+                // Retrieve the derivatives of all of the parents, those outside of the flow tree have none
                 NodeVec parent_derivatives;
-                NodeVec parents = get_parents();
+                NodeView const parents = parents_view();
+                bool any_derivative = false;
                 for(auto i=0; i<parents.size(); ++i){
-                    parent_derivatives.push_back(all_derivatives[parents[i]->id]);
+                    auto const parent_position = flow_tree.position(parents[i]->id);
+                    parent_derivatives.push_back(parent_position != FlowTree::missing ?
+                                                 all_derivatives[parent_position] : Node());
+                    any_derivative = any_derivative or not parent_derivatives.back().empty();
+                }
+                if(not any_derivative){
+                    return;
                 }
                 op_logger(name)->debug("Generating derivative for {}", result->id);
 
@@ -125,16 +184,18 @@ namespace md{
 
                 NodeVec messages;
                 for (int i = 0; i < parents.size(); ++i) {
-                    if (not parent_derivatives[i].ptr.expired()) {
+                    if (not parent_derivatives[i].empty()) {
                         auto msg = forward_diff_parent(parent_derivatives, i);
-                        if (not msg.ptr.expired()) {
-                            // Change name of the message
-                            if (msg->name == "Derived Node" or msg->name == "") {
-                                msg->name = "Grad msg " + std::to_string(parents[i]->id) + "->"
-                                            + std::to_string(result->id) + "|";
-                            } else {
-                                msg->name += "Grad msg " + std::to_string(result->id) + "->"
-                                             + std::to_string(parents[i]->id) + "|";
+                        if (not msg.empty()) {
+                            // Change name of the message, unless it is an older node it was merged with
+                            if (msg->id >= graph->diff_start) {
+                                if (msg->name == "Derived Node" or msg->name == "") {
+                                    msg->name = "Grad msg " + std::to_string(parents[i]->id) + "->"
+                                                + std::to_string(result->id) + "|";
+                                } else {
+                                    msg->name += "Grad msg " + std::to_string(result->id) + "->"
+                                                 + std::to_string(parents[i]->id) + "|";
+                                }
                             }
                             messages.push_back(msg);
                         }
@@ -144,7 +205,7 @@ namespace md{
                 if(messages.size() == 0) {
                     // Leave to empty Node
                 } else {
-                    all_derivatives[result->id] = forward_diff_combine(messages);
+                    all_derivatives[position] = forward_diff_combine(messages);
                 }
 
                 // Restore group
@@ -6,6 +6,30 @@
 
 namespace md{
     namespace api{
+        namespace {
+            /** Whether negating a value of the data type does not change its type */
+            bool is_signed(DataType const data_type){
+                return data_type.type != BOOLEAN and data_type.type != UNSIGNED_INT;
+            }
+
+            /** Moves to the front an operand with the data type and shape which the operation over all of the nodes
+             * would have, such that the operation over the operands alone has them as well.
+             * Returns false if there is no such operand. */
+            bool keep_result_type(NodeVec const & nodes, NodeVec & operands, std::vector<bool> & flags,
+                                  std::string const op_name){
+                SymShape const shape = nodes[0].order() > 0 ? get_max_shape(nodes, op_name) : nodes[0]->shape;
+                for(auto i=0; i<operands.size(); ++i){
+                    if(operands[i]->data_type == nodes[0]->data_type and not (operands[i]->shape != shape)){
+                        std::swap(operands[0], operands[i]);
+                        bool const flag = flags[0];
+                        flags[0] = flags[i];
+                        flags[i] = flag;
+                        return true;
+                    }
+                }
+                return false;
+            }
+        }
 
         Node add(NodeVec nodes, std::vector<bool> neg){
             if(nodes.size() == 0){
@@ -29,10 +53,34 @@ namespace md{
                     neg.push_back(false);
                 }
             }
+            // Terms of zero do not change the sum and negated terms are folded into their sign
+            NodeVec terms;
+            std::vector<bool> terms_neg;
+            bool folded = false;
+            for(auto i=0; i<nodes.size(); ++i){
+                Node const base = get_base_node(nodes[i]);
+                if(is_constant_value(nodes[i], 0)){
+                    folded = true;
+                } else if(base->op->kind == OpKind::Add and base->op->parents_view().size() == 1){
+                    auto cast_op = std::dynamic_pointer_cast<op::Add>(base->op);
+                    terms.push_back(base->op->parents_view()[0]);
+                    terms_neg.push_back(neg[i] != cast_op->neg[0]);
+                    folded = true;
+                } else {
+                    terms.push_back(nodes[i]);
+                    terms_neg.push_back(neg[i]);
+                }
+            }
+            if(folded and keep_result_type(nodes, terms, terms_neg, "Add")){
+                if(terms.size() > 1){
+                    return add(terms, terms_neg);
+                }
+                return terms_neg[0] ? api::neg(terms[0]) : terms[0];
+            }
             // TODO check for redundancies like x + (-x)
             verify_shapes_and_broadcast(nodes, "Add");
             // Standard
-            Operator op = std::make_shared<op::Add>(g.get(), nodes, neg);
+            Operator op = make_operator<op::Add>(g.get(), nodes, neg);
             return g->derived_node(op);
         }
 
@@ -53,18 +101,23 @@ namespace md{
             // Enforcing neg(neg(x)) = x
             auto base = get_base_node(node);
             // The -(-x) = x
-            if(base->op->name == "Add" and base->op->get_parents().size() == 1){
+            if(base->op->kind == OpKind::Add and base->op->parents_view().size() == 1){
                 auto cast_op = std::dynamic_pointer_cast<op::Add>(base->op);
                 if(cast_op->neg[0]) {
-                    alias(base->op->get_parents()[0]);
+                    return base->op->parents_view()[0];
                 } else {
-                    Operator op =  std::make_shared<op::Add>(g.get(), base->op->get_parents(),
+                    Operator op =  make_operator<op::Add>(g.get(), base->op->get_parents(),
                                                              std::vector<bool> {true});
                     return g->derived_node(op);
                 }
             }
+            // The negation of a constant is a constant
+            if(base->op->kind == OpKind::ConstantValue and is_signed(base->data_type)){
+                auto cast_op = std::dynamic_pointer_cast<op::ConstantValue>(base->op);
+                return g->constant(-cast_op->value, base->data_type, cast_op->shape);
+            }
             // Standard
-            Operator op = std::make_shared<op::Add>(g.get(), NodeVec {node}, std::vector<bool> {true});
+            Operator op = make_operator<op::Add>(g.get(), NodeVec {node}, std::vector<bool> {true});
             return g->derived_node(op);
         }
 
@@ -97,10 +150,33 @@ namespace md{
                     div.push_back(false);
                 }
             }
+            // Factors of one do not change the product and factors of minus one only its sign
+            NodeVec factors;
+            std::vector<bool> factors_div;
+            bool negate = false;
+            for(auto i=0; i<nodes.size(); ++i){
+                if(is_constant_value(nodes[i], 1)){
+                    continue;
+                } else if(is_constant_value(nodes[i], -1) and is_signed(nodes[0]->data_type)){
+                    negate = not negate;
+                } else {
+                    factors.push_back(nodes[i]);
+                    factors_div.push_back(div[i]);
+                }
+            }
+            if(factors.size() < nodes.size() and keep_result_type(nodes, factors, factors_div, "Mul")){
+                Node product = factors[0];
+                if(factors.size() > 1){
+                    product = mul(factors, factors_div);
+                } else if(factors_div[0]){
+                    product = api::div(factors[0]);
+                }
+                return negate ? neg(product) : product;
+            }
             // TODO check for redundancies like x * (1/x)
             verify_shapes_and_broadcast(nodes, "Mul");
             // Standard
-            Operator op = std::make_shared<op::Mul>(g.get(), nodes, div);
+            Operator op = make_operator<op::Mul>(g.get(), nodes, div);
             return g->derived_node(op);
         }
 
@@ -121,18 +197,18 @@ namespace md{
             // Enforcing neg(neg(x)) = x
             auto base = get_base_node(node);
             // The div(div(x)) = x
-            if(base->op->name == "Mul" and base->op->get_parents().size() == 1){
+            if(base->op->kind == OpKind::Mul and base->op->parents_view().size() == 1){
                 auto cast_op = std::dynamic_pointer_cast<op::Mul>(base->op);
                 if(cast_op->div[0]) {
-                    alias(base->op->get_parents()[0]);
+                    return base->op->parents_view()[0];
                 } else {
-                    Operator op =  std::make_shared<op::Mul>(g.get(), base->op->get_parents(),
+                    Operator op =  make_operator<op::Mul>(g.get(), base->op->get_parents(),
                                                              std::vector<bool> {true});
                     return g->derived_node(op);
                 }
             }
             // Standard
-            Operator op = std::make_shared<op::Mul>(g.get(), NodeVec {node}, std::vector<bool> {true});
+            Operator op = make_operator<op::Mul>(g.get(), NodeVec {node}, std::vector<bool> {true});
             return g->derived_node(op);
         }
 
@@ -155,7 +231,7 @@ namespace md{
                 node2 = implicit_cast(node2, DataType(SIGNED_INT, g->props.max_int), "IntDiv");
             }
             // Standard
-            Operator op = std::make_shared<op::IntDiv>(g.get(), node1, node2);
+            Operator op = make_operator<op::IntDiv>(g.get(), node1, node2);
             return g->derived_node(op);
         }
 
@@ -174,7 +250,7 @@ namespace md{
                 node2 = implicit_cast(node2, DataType(SIGNED_INT, g->props.max_int), "IntDiv");
             }
             // Standard
-            Operator op = std::make_shared<op::IntMod>(g.get(), node1, node2);
+            Operator op = make_operator<op::IntMod>(g.get(), node1, node2);
             return g->derived_node(op);
         }
     }
@@ -7,7 +7,7 @@
 namespace md{
     namespace gir{
         Node GraphInternal::sym_int_node(SymInt value) {
-            Operator op = std::make_shared<op::SymIntWrapper>(this, value);
+            Operator op = make_operator<op::SymIntWrapper>(this, value);
             return derived_node(op);
         }
 
@@ -15,7 +15,7 @@ namespace md{
             // Limit the data type based on the max allowed
             DataType limit = limit_type(data_type);
             // Standard
-            return derived_node(std::make_shared<op::ConstantValue>(this, value, limit, shape));
+            return derived_node(make_operator<op::ConstantValue>(this, value, limit, shape));
         }
 
         Node GraphInternal::PI() {
@@ -50,7 +50,7 @@ namespace md{
         }
 
         Node GraphInternal::range(SymInt start, SymInt end, DataType data_type){
-            auto op = std::make_shared<op::Range>(this, start, end, data_type);
+            auto op = make_operator<op::Range>(this, start, end, data_type);
             return derived_node(op);
         }
 
@@ -59,7 +59,7 @@ namespace md{
         }
 
         Node GraphInternal::eye(SymInt size, DataType data_type){
-            auto op = std::make_shared<op::Eye>(this, size, data_type);
+            auto op = make_operator<op::Eye>(this, size, data_type);
             return derived_node(op);
         }
 
@@ -116,18 +116,18 @@ namespace md{
 //            // Limit the data type based on the max allowed
 //            DataType limit = limit_type(data_type);
 //            // Standard
-//            return derived_node(std::make_shared<op::ConstantValue>(g.get(), value, limit, shape));
+//            return derived_node(make_operator<op::ConstantValue>(g.get(), value, limit, shape));
 //        }
 //
 //        Node shared_var(SharedVar var){
-//            Operator op = std::make_shared<op::SharedInput>(g.get(), var);
+//            Operator op = make_operator<op::SharedInput>(g.get(), var);
 //            Node node = derived_node(op);
 //            node->name = var->name;
 //            return node;
 //        }
 //
 //        Node sym_int_node(SymInt value) {
-//            Operator op = std::make_shared<op::SymIntWrapper>(g.get(), value);
+//            Operator op = make_operator<op::SymIntWrapper>(g.get(), value);
 //            return derived_node(op);
 //        }
 //
@@ -163,7 +163,7 @@ namespace md{
 //        }
 //
 //        Node range(SymInt start, SymInt end, DataType data_type){
-//            auto op = std::make_shared<op::Range>(g.get(), start, end, data_type);
+//            auto op = make_operator<op::Range>(g.get(), start, end, data_type);
 //            return derived_node(op);
 //        }
 //
@@ -172,7 +172,7 @@ namespace md{
 //        }
 //
 //        Node eye(SymInt size, DataType data_type){
-//            auto op = std::make_shared<op::Eye>(g.get(), size, data_type);
+//            auto op = make_operator<op::Eye>(g.get(), size, data_type);
 //            return derived_node(op);
 //        }
 //
@@ -8,7 +8,7 @@ namespace md{
     namespace api{
         Node print(Node monitored, std::string msg, Node anchor){
             Graph g = monitored.g();
-            if(anchor.ptr.expired()) {
+            if(anchor.empty()) {
                 // If the anchor is empty use the monitored
                 anchor = monitored;
             }
@@ -17,13 +17,13 @@ namespace md{
                 throw InvalidOperatorArgument({anchor, monitored}, "Print", "The anchor is dependent on the monitored.");
             }
             // Standard
-            Operator op = std::make_shared<op::Print>(g.get(), anchor, monitored, msg);
+            Operator op = make_operator<op::Print>(g.get(), anchor, monitored, msg);
             return g->derived_node(op);
         }
 
         Node retrieve(Node monitored, std::string msg, Node anchor){
             Graph g = monitored.g();
-            if(anchor.ptr.expired()) {
+            if(anchor.empty()) {
                 // If the anchor is empty use the monitored
                 anchor = monitored;
             }
@@ -32,13 +32,13 @@ namespace md{
                 throw InvalidOperatorArgument({anchor, monitored}, "Retrieve", "The anchor is dependent on the monitored.");
             }
             // Standard
-            Operator op = std::make_shared<op::Retrieve>(g.get(), anchor, monitored, msg);
+            Operator op = make_operator<op::Retrieve>(g.get(), anchor, monitored, msg);
             return g->derived_node(op);
         }
 
         Node log_to_file(Node monitored, std::string msg, Node anchor){
             Graph g = monitored.g();
-            if(anchor.ptr.expired()) {
+            if(anchor.empty()) {
                 // If the anchor is empty use the monitored
                 anchor = monitored;
             }
@@ -49,13 +49,13 @@ namespace md{
                                               + " is dependent on the monitored " + std::to_string(monitored->id) + ".");
             }
             // Standard
-            Operator op = std::make_shared<op::LogToFile>(g.get(), anchor, monitored, msg);
+            Operator op = make_operator<op::LogToFile>(g.get(), anchor, monitored, msg);
             return g->derived_node(op);
         }
 
         Node guard(Node monitored, std::string msg, double low, double high, Node anchor){
             Graph g = monitored.g();
-            if(anchor.ptr.expired()) {
+            if(anchor.empty()) {
                 // If the anchor is empty use the monitored
                 anchor = monitored;
             }
@@ -72,7 +72,7 @@ namespace md{
                                               + " is not < the high value " + std::to_string(high) + ".");
             }
             // Standard
-            Operator op = std::make_shared<op::Guard>(g.get(), anchor, monitored, msg, low, high);
+            Operator op = make_operator<op::Guard>(g.get(), anchor, monitored, msg, low, high);
             return g->derived_node(op);
         }
     }
@@ -10,13 +10,13 @@ namespace md{
             Graph g = node.g();
             // If parent is a positive operator do nothing
             auto base = get_base_node(node);
-            if(base->op->name == "Square" or base->op->name == "Exp"
-               or base->op->name == "Sigmoid" or base->op->name == "Log1p"
-               or base->op->name == "Softplus"){
+            if(base->op->kind == OpKind::Square or base->op->kind == OpKind::Exp
+               or base->op->kind == OpKind::Sigmoid or base->op->kind == OpKind::Log1p
+               or base->op->kind == OpKind::Softplus){
                 return alias(node);
             }
             // Standard
-            Operator op = std::make_shared<op::Abs>(g.get(), node);
+            Operator op = make_operator<op::Abs>(g.get(), node);
             return g->derived_node(op);
         }
 
@@ -24,15 +24,15 @@ namespace md{
             Graph g = node.g();
             // If parent is square root return the upper node
             auto base = get_base_node(node);
-            if(base->op->name == "Sqrt"){
-                return alias(base->op->get_parents()[0]);
+            if(base->op->kind == OpKind::Sqrt){
+                return alias(base->op->parents_view()[0]);
             }
             // If the parent is abs, return the square of its parent
-            if(base->op->name == "Abs"){
-                node = base->op->get_parents()[0];
+            if(base->op->kind == OpKind::Abs){
+                node = base->op->parents_view()[0];
             }
             // Standard
-            Operator op = std::make_shared<op::Square>(g.get(), node);
+            Operator op = make_operator<op::Square>(g.get(), node);
             return g->derived_node(op);
         }
 
@@ -40,11 +40,11 @@ namespace md{
             Graph g = node.g();
             // If parent is square return abs
             auto base = get_base_node(node);
-            if(base->op->name == "Square"){
-                return abs(base->op->get_parents()[0]);
+            if(base->op->kind == OpKind::Square){
+                return abs(base->op->parents_view()[0]);
             }
             // Standard
-            Operator op = std::make_shared<op::Sqrt>(g.get(), node);
+            Operator op = make_operator<op::Sqrt>(g.get(), node);
             return g->derived_node(op);
         }
 
@@ -52,11 +52,11 @@ namespace md{
             Graph g = node.g();
             // If parent is log return the upper node
             auto base = get_base_node(node);
-            if(base->op->name == "Log"){
-                return alias(base->op->get_parents()[0]);
+            if(base->op->kind == OpKind::Log){
+                return alias(base->op->parents_view()[0]);
             }
             // Standard
-            Operator op = std::make_shared<op::Exp>(g.get(), node);
+            Operator op = make_operator<op::Exp>(g.get(), node);
             return g->derived_node(op);
         }
 
@@ -64,11 +64,11 @@ namespace md{
             Graph g = node.g();
             // If parent is exp return the upper node
             auto base = get_base_node(node);
-            if(base->op->name == "Exp"){
-                return alias(base->op->get_parents()[0]);
+            if(base->op->kind == OpKind::Exp){
+                return alias(base->op->parents_view()[0]);
             }
             // Standard
-            Operator op = std::make_shared<op::Log>(g.get(), node);
+            Operator op = make_operator<op::Log>(g.get(), node);
             return g->derived_node(op);
         }
 
@@ -76,74 +76,74 @@ namespace md{
             Graph g = node.g();
             // If parent is exp return the upper node
             auto base = get_base_node(node);
-            if(base->op->name == "Exp"){
-                return base->op->get_parents()[0] * g->LN_10();
+            if(base->op->kind == OpKind::Exp){
+                return base->op->parents_view()[0] * g->LN_10();
             }
             // Standard
-            Operator op = std::make_shared<op::Log10>(g.get(), node);
+            Operator op = make_operator<op::Log10>(g.get(), node);
             return g->derived_node(op);
         }
 
         Node log1p(Node node){
             Graph g = node.g();
             // Standard
-            Operator op = std::make_shared<op::Log1p>(g.get(), node);
+            Operator op = make_operator<op::Log1p>(g.get(), node);
             return g->derived_node(op);
         }
 
         Node sin(Node node){
             Graph g = node.g();
             // Standard
-            Operator op = std::make_shared<op::Sin>(g.get(), node);
+            Operator op = make_operator<op::Sin>(g.get(), node);
             return g->derived_node(op);
         }
 
         Node cos(Node node){
             Graph g = node.g();
             // Standard
-            Operator op = std::make_shared<op::Cos>(g.get(), node);
+            Operator op = make_operator<op::Cos>(g.get(), node);
             return g->derived_node(op);
         }
 
         Node tan(Node node){
             Graph g = node.g();
             // Standard
-            Operator op = std::make_shared<op::Tan>(g.get(), node);
+            Operator op = make_operator<op::Tan>(g.get(), node);
             return g->derived_node(op);
         }
 
         Node cot(Node node){
             Graph g = node.g();
             // Standard
-            Operator op = std::make_shared<op::Cot>(g.get(), node);
+            Operator op = make_operator<op::Cot>(g.get(), node);
             return g->derived_node(op);
         }
 
         Node sinh(Node node){
             Graph g = node.g();
             // Standard
-            Operator op = std::make_shared<op::Sinh>(g.get(), node);
+            Operator op = make_operator<op::Sinh>(g.get(), node);
             return g->derived_node(op);
         }
 
         Node cosh(Node node){
             Graph g = node.g();
             // Standard
-            Operator op = std::make_shared<op::Cosh>(g.get(), node);
+            Operator op = make_operator<op::Cosh>(g.get(), node);
             return g->derived_node(op);
         }
 
         Node tanh(Node node){
             Graph g = node.g();
             // Standard
-            Operator op = std::make_shared<op::Tanh>(g.get(), node);
+            Operator op = make_operator<op::Tanh>(g.get(), node);
             return g->derived_node(op);
         }
 
         Node coth(Node node){
             Graph g = node.g();
             // Standard
-            Operator op = std::make_shared<op::Coth>(g.get(), node);
+            Operator op = make_operator<op::Coth>(g.get(), node);
             return g->derived_node(op);
         }
 
@@ -154,7 +154,7 @@ namespace md{
                 throw InvalidOperatorArgument(NodeVec{node, power},
                                               "Power", "The input variables are not from the same graph.");
             }
-            if(power.order() == 0 and power->op->name == "ConstValue"){
+            if(power.order() == 0 and power->op->kind == OpKind::ConstantValue){
                 auto cast_op = std::dynamic_pointer_cast<op::ConstantValue>(power->op);
                 if(cast_op->value == 2){
                     return square(node);
@@ -167,7 +167,7 @@ namespace md{
             NodeVec nodes = {node, power};
             verify_shapes_and_broadcast(nodes, "Power");
             // Standard
-            Operator op = std::make_shared<op::LogicalAnd>(g.get(), nodes[0], nodes[1]);
+            Operator op = make_operator<op::LogicalAnd>(g.get(), nodes[0], nodes[1]);
             return g->derived_node(op);
         }
     }
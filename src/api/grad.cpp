@@ -6,20 +6,74 @@
 
 namespace md{
     namespace api{
+        namespace {
+            /** Returns the evaluation point of the gradient of f, verifying that it is a scalar */
+            Node gradient_seed(Node const f){
+                Graph g = f.g();
+                // Verify that the objective is a scalar
+                if (f.order() != 0) {
+                    op_logger("Grad")->error("Requested gradient with respect to a non-scalar function.");
+                    throw InvalidOperatorArgument(NodeVec{f}, "Grad", "Requested gradient with respect to a non-scalar function.");
+                }
+                // The seed belongs to the gradient, so it is kept apart from an equal constant of the forward pass,
+                // but is shared by all gradients of the same level such that they can be served by the cache
+                unsigned int const level = f->grad_level + ((unsigned int)(1));
+                Operator const op = make_operator<op::ConstantValue>(g.get(), 1.0, g->limit_type(f->data_type),
+                                                                     Shape{1, 1, 1, 1});
+                auto const it = g->structure_map.find(op->hash());
+                if(it != g->structure_map.end()){
+                    for(auto i = 0; i < it->second.size(); ++i){
+                        if(it->second[i]->grad_level == level and op->equals(it->second[i]->op)){
+                            return it->second[i];
+                        }
+                    }
+                }
+                unsigned int const old_level = g->grad_level;
+                g->grad_level = level;
+                Node const u = g->duplicate_node(op, "Gradient seed");
+                g->grad_level = old_level;
+                return u;
+            }
+        }
+
         NodeVec gradient(Node const f, NodeVec const & w) {
             // If no parameters return empty vector as well
+            if(w.size() == 0){
+                return NodeVec();
+            }
+            return f.g()->backward_diff(NodeVec{f}, NodeVec{gradient_seed(f)}, w);
+        };
+
+        NodeVec gradient(Node const f, NodeVec const & w, NodeSet const & checkpoints) {
+            if(w.size() == 0){
+                return NodeVec();
+            }
+            return f.g()->backward_diff(NodeVec{f}, NodeVec{gradient_seed(f)}, w, checkpoints);
+        };
+
+        NodeVec gradient(Node const f, NodeVec const & w, size_t const max_checkpoints) {
             if(w.size() == 0){
                 return NodeVec();
             }
             Graph g = f.g();
-            // Verify that the objective is a scalar
-            if (f.order() != 0) {
-                op_logger("Grad")->error("Requested gradient with respect to a non-scalar function.");
-                throw InvalidOperatorArgument(NodeVec{f}, "Grad", "Requested gradient with respect to a non-scalar function.");
+            return gradient(f, w, g->select_checkpoints(NodeVec{f}, w, max_checkpoints));
+        };
+
+        std::vector<NodeVec> gradients(NodeVec const & f, NodeVec const & w, size_t const threads) {
+            if(f.empty()){
+                return std::vector<NodeVec>();
+            }
+            // The seeds are made upfront, as the graph is only read while building concurrently
+            std::vector<NodeVec> objectives, seeds;
+            for(auto i = 0; i < f.size(); ++i){
+                objectives.push_back(NodeVec{f[i]});
+                seeds.push_back(NodeVec{gradient_seed(f[i])});
             }
-            NodeVec u = {g->constant(1)};
-            u[0]->grad_level = f->grad_level + ((unsigned int)(1));
-            return g->backward_diff(NodeVec{f}, u, w);
+            return f[0].g()->backward_diff_concurrently(objectives, seeds, w, threads);
+        };
+
+        NodeVec jacobian(Node const f, NodeVec const & w) {
+            return f.g()->jacobian(f, w);
         };
     }
 }
\ No newline at end of file
@@ -11,25 +11,23 @@ namespace md{
             auto var_name = scope;
             var_name += props.scope_delimiter;
             var_name += name;
-            Operator op = std::make_shared<op::Parameter>(this, var_name, data_type, shape);
+            Operator op = make_operator<op::Parameter>(this, var_name, data_type, shape);
             Node node = derived_node(op);
             node->name = var_name;
             return node;
         }
 
         Node GraphInternal::parameter(std::string name, DataType data_type, Shape shape){
-            return parameter(scope, name, data_type, shape);
+            return parameter(scopes.full_name(scope), name, data_type, shape);
         }
 
         Node GraphInternal::tensor4(DataType data_type,
                                     std::array<SymInt, 4> shape,
                                     std::string name) {
-            auto op = std::make_shared<op::Input>(this, data_type, shape);
-            auto result = std::make_shared<NodeData>(shared_from_this(), nodes.size(),
-                                                     name, props.default_device,
-                                                     op, 0, scope);
-            nodes.push_back(result);
+            auto op = make_operator<op::Input>(this, data_type, shape);
+            Node result = nodes.emplace(name, props.default_device, op, 0, scope);
             result->op->result = result;
+            edges.append(NodeVec{});
             // Add the node to the group map
             if(group_map.find(scope) == group_map.end()){
                 group_map[scope] = NodeVec{result};
@@ -37,10 +35,10 @@ namespace md{
                 group_map[scope].push_back(result);
             }
             // Add the node to the op map
-            if(op_map.find(op->name) == op_map.end()){
-                op_map[op->name] = NodeVec{result};
+            if(op_map.find(op->kind) == op_map.end()){
+                op_map[op->kind] = NodeVec{result};
             } else {
-                op_map[op->name].push_back(result);
+                op_map[op->kind].push_back(result);
             }
             return result;
         }
@@ -134,7 +132,7 @@ namespace md{
 //                     std::array<SymInt, 4> shape,
 //                     std::string name,
 //                     Graph g) {
-//            auto op = std::make_shared<op::Input>(g.get(), data_type, shape);
+//            auto op = make_operator<op::Input>(g.get(), data_type, shape);
 //            auto result = std::make_shared<NodeData>(g, g->nodes.size(),
 //                    name, g->props.default_device,
 //                    op, 0, g->current_group);
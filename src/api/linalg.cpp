@@ -59,7 +59,7 @@ namespace md{
             }
             // TODO check any two consecutive are inverse of each other
             // Standard
-            auto op = std::make_shared<op::MatrixMul>(g.get(), nodes, transpositions);
+            auto op = make_operator<op::MatrixMul>(g.get(), nodes, transpositions);
             return g->derived_node(op);
         }
 
@@ -80,11 +80,14 @@ namespace md{
             }
             // matrix_inv(matrix_inv(x)) = x
             auto base = get_base_node(node);
-            if(base->op->name == "MatrixInv"){
-                return alias(base->op->get_parents()[0]);
+            if(base->op->kind == OpKind::MatrixInverse){
+                auto cast_op = std::dynamic_pointer_cast<op::MatrixInverse>(base->op);
+                if(cast_op->t == transpose){
+                    return alias(base->op->parents_view()[0]);
+                }
             }
             // Standard
-            Operator op = std::make_shared<op::MatrixInverse>(g.get(), node, transpose);
+            Operator op = make_operator<op::MatrixInverse>(g.get(), node, transpose);
             return g->derived_node(op);
         }
 
@@ -114,14 +117,15 @@ namespace md{
             // TODO check any two consecutive are inverse of each other
             // matrix_inv(matrix_inv(x)) = x
             auto base = get_base_node(node1);
-            if(base->op->name == "MatrixInv"){
-                return dot(base->op->get_parents()[0], node2, transpose_inv, transpose_mul);
+            if(base->op->kind == OpKind::MatrixInverse){
+                auto cast_op = std::dynamic_pointer_cast<op::MatrixInverse>(base->op);
+                return dot(base->op->parents_view()[0], node2, cast_op->t != transpose_inv, transpose_mul);
             }
             // matrix_inv(x) * x = I
             if(symbolic_equals(node1, node2)){
                 return g->eye(node1->shape[0]);
             }
-            Operator op = std::make_shared<op::MatrixInverseMul>(g.get(), node1, node2, transpose_inv, transpose_mul);
+            Operator op = make_operator<op::MatrixInverseMul>(g.get(), node1, node2, transpose_inv, transpose_mul);
             return g->derived_node(op);
         }
 
@@ -140,7 +144,7 @@ namespace md{
                                               "Node is not a square matrix.");
             }
             // Standard
-            Operator op = std::make_shared<op::Determinant>(g.get(), node);
+            Operator op = make_operator<op::Determinant>(g.get(), node);
             return g->derived_node(op);
         }
 
@@ -159,7 +163,7 @@ namespace md{
                                               "Node is not a square matrix.");
             }
             // Standard
-            Operator op = std::make_shared<op::LogDeterminant>(g.get(), node);
+            Operator op = make_operator<op::LogDeterminant>(g.get(), node);
             return g->derived_node(op);
         }
 
@@ -179,7 +183,7 @@ namespace md{
             }
             // TODO if node is b8 cast it to max_int
             // Standard
-            Operator op = std::make_shared<op::Trace>(g.get(), node);
+            Operator op = make_operator<op::Trace>(g.get(), node);
             return g->derived_node(op);
         }
 
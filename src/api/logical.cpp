@@ -15,12 +15,12 @@ namespace md{
             } else {
                 auto base = get_base_node(node);
                 // The not(not(x)) = x
-                if (base->op->name == "LogicalNot") {
-                    return api::alias(base->op->get_parents()[0]);
+                if (base->op->kind == OpKind::LogicalNot) {
+                    return api::alias(base->op->parents_view()[0]);
                 }
             }
             // Standard
-            Operator op = std::make_shared<op::LogicalNot>(g.get(), node);
+            Operator op = make_operator<op::LogicalNot>(g.get(), node);
             return g->derived_node(op);
         }
 
@@ -47,7 +47,7 @@ namespace md{
                 return nodes[0];
             }
             // Standard
-            Operator op = std::make_shared<op::LogicalAnd>(g.get(), nodes[0], nodes[1]);
+            Operator op = make_operator<op::LogicalAnd>(g.get(), nodes[0], nodes[1]);
             return g->derived_node(op);
         }
 
@@ -74,7 +74,7 @@ namespace md{
                 return nodes[0];
             }
             // Standard
-            Operator op = std::make_shared<op::LogicalOr>(g.get(), nodes[0], nodes[1]);
+            Operator op = make_operator<op::LogicalOr>(g.get(), nodes[0], nodes[1]);
             return g->derived_node(op);
         }
 
@@ -93,7 +93,7 @@ namespace md{
                 return g->zeros(nodes[0]->shape, b8);
             }
             // Standard
-            Operator op = std::make_shared<op::GreaterThan>(g.get(), nodes[0], nodes[1]);
+            Operator op = make_operator<op::GreaterThan>(g.get(), nodes[0], nodes[1]);
             return g->derived_node(op);
         }
 
@@ -112,7 +112,7 @@ namespace md{
                 return g->zeros(nodes[0]->shape, b8);
             }
             // Standard
-            Operator op = std::make_shared<op::LessThan>(g.get(), nodes[0], nodes[1]);
+            Operator op = make_operator<op::LessThan>(g.get(), nodes[0], nodes[1]);
             return g->derived_node(op);
         }
 
@@ -131,7 +131,7 @@ namespace md{
                 return g->ones(nodes[0]->shape, b8);
             }
             // Standard
-            Operator op = std::make_shared<op::GreaterThanOrEqual>(g.get(), nodes[0], nodes[1]);
+            Operator op = make_operator<op::GreaterThanOrEqual>(g.get(), nodes[0], nodes[1]);
             return g->derived_node(op);
         }
 
@@ -150,7 +150,7 @@ namespace md{
                 return g->ones(nodes[0]->shape, b8);
             }
             // Standard
-            Operator op = std::make_shared<op::LessThanOrEqual>(g.get(), nodes[0], nodes[1]);
+            Operator op = make_operator<op::LessThanOrEqual>(g.get(), nodes[0], nodes[1]);
             return g->derived_node(op);
         }
 
@@ -169,7 +169,7 @@ namespace md{
                 return g->ones(nodes[0]->shape, b8);
             }
             // Standard
-            Operator op = std::make_shared<op::Equals>(g.get(), nodes[0], nodes[1]);
+            Operator op = make_operator<op::Equals>(g.get(), nodes[0], nodes[1]);
             return g->derived_node(op);
         }
 
@@ -188,7 +188,7 @@ namespace md{
                 return g->ones(nodes[0]->shape, b8);
             }
             // Standard
-            Operator op = std::make_shared<op::NotEquals>(g.get(), nodes[0], nodes[1]);
+            Operator op = make_operator<op::NotEquals>(g.get(), nodes[0], nodes[1]);
             return g->derived_node(op);
         }
 
@@ -207,21 +207,21 @@ namespace md{
                 return g->ones(nodes[0]->shape, b8);
             }
             // Standard
-            Operator op = std::make_shared<op::ApproximatelyEquals>(g.get(), nodes[0], nodes[1], tolerance);
+            Operator op = make_operator<op::ApproximatelyEquals>(g.get(), nodes[0], nodes[1], tolerance);
             return g->derived_node(op);
         }
 
         Node isNan(Node node){
             Graph g = node.g();
             // Standard
-            Operator op = std::make_shared<op::IsNaN>(g.get(), node);
+            Operator op = make_operator<op::IsNaN>(g.get(), node);
             return g->derived_node(op);
         }
 
         Node isInf(Node node){
             Graph g = node.g();
             // Standard
-            Operator op = std::make_shared<op::IsInf>(g.get(), node);
+            Operator op = make_operator<op::IsInf>(g.get(), node);
             return g->derived_node(op);
         }
     }
@@ -10,14 +10,14 @@ namespace md{
         Node softplus(Node node, double threshold){
             Graph g = node.g();
             // Standard
-            Operator op = std::make_shared<op::Softplus>(g.get(), node, threshold);
+            Operator op = make_operator<op::Softplus>(g.get(), node, threshold);
             return g->derived_node(op);
         }
 
         Node sigmoid(Node node) {
             Graph g = node.g();
             // Standard
-            Operator op = std::make_shared<op::Sigmoid>(g.get(), node);
+            Operator op = make_operator<op::Sigmoid>(g.get(), node);
             return g->derived_node(op);
         }
 
@@ -31,13 +31,13 @@ namespace md{
             // Verify correctness
             Graph g = node.g();
             auto base = get_base_node(node);
-            if (base->op->name == "Log") {
+            if (base->op->kind == OpKind::Log) {
                 // If the parent is a log return remove it
                 auto cast_op = std::dynamic_pointer_cast<op::Log>(base->op);
                 return log(sum(cast_op->parent, axes));
             }
             // Standard
-            Operator op = std::make_shared<op::LogSumExp>(g.get(), node, axes);
+            Operator op = make_operator<op::LogSumExp>(g.get(), node, axes);
             return g->derived_node(op);
         }
 
@@ -68,7 +68,7 @@ namespace md{
             // Verify correctness
             Graph g = node.g();
             // Standard
-            Operator op = std::make_shared<op::Softmax>(g.get(), node, axes);
+            Operator op = make_operator<op::Softmax>(g.get(), node, axes);
             return g->derived_node(op);
 
         }
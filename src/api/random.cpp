@@ -8,12 +8,12 @@ namespace md{
     namespace gir{
 
         Node GraphInternal::random_uniform(Shape shape) {
-            Operator op = std::make_shared<op::RandomUniform>(this, shape);
+            Operator op = make_operator<op::RandomUniform>(this, shape);
             return derived_node(op);
         }
 
         Node GraphInternal::random_normal(Shape shape) {
-            Operator op = std::make_shared<op::RandomNormal>(this, shape);
+            Operator op = make_operator<op::RandomNormal>(this, shape);
             return derived_node(op);
         }
     }
@@ -18,15 +18,15 @@ namespace md{
             Graph g = node.g();
             auto base = get_base_node(node);
             // The sum(sum(x,a),b) = sum(x, a U b)
-            if (base->op->name == "Sum") {
+            if (base->op->kind == OpKind::Sum) {
                 auto cast_op = std::dynamic_pointer_cast<op::Sum>(base->op);
                 for(auto i=0; i < cast_op->axes.size(); ++i){
                     axes.push_back(cast_op->axes[i]);
                 }
-                return sum(base->op->get_parents()[0], axes);
+                return sum(base->op->parents_view()[0], axes);
             }
             // Standard
-            Operator op = std::make_shared<op::Sum>(g.get(), node, axes);
+            Operator op = make_operator<op::Sum>(g.get(), node, axes);
             return g->derived_node(op);
         }
 
@@ -57,15 +57,15 @@ namespace md{
             Graph g = node.g();
             auto base = get_base_node(node);
             // The mean(mean(x,a),b) = mean(x, a U b)
-            if (base->op->name == "Mean") {
+            if (base->op->kind == OpKind::Mean) {
                 auto cast_op = std::dynamic_pointer_cast<op::Mean>(base->op);
                 for(auto i=0; i < cast_op->axes.size(); ++i){
                     axes.push_back(cast_op->axes[i]);
                 }
-                return mean(base->op->get_parents()[0], axes);
+                return mean(base->op->parents_view()[0], axes);
             }
             // Standard
-            Operator op = std::make_shared<op::Mean>(g.get(), node, axes);
+            Operator op = make_operator<op::Mean>(g.get(), node, axes);
             return g->derived_node(op);
         }
 
@@ -95,7 +95,7 @@ namespace md{
             // Verify correctness
             Graph g = node.g();
             // Standard
-            Operator op = std::make_shared<op::Variance>(g.get(), node, axes);
+            Operator op = make_operator<op::Variance>(g.get(), node, axes);
             return g->derived_node(op);
         }
 
@@ -125,16 +125,16 @@ namespace md{
             // Verify correctness
             Graph g = node.g();
             auto base = get_base_node(node);
-            if (base->op->name == "Product") {
+            if (base->op->kind == OpKind::Product) {
                 // The prod(prod(x,a),b) = prod(x, a U b)
                 auto cast_op = std::dynamic_pointer_cast<op::Product>(base->op);
                 for(auto i=0; i < cast_op->axes.size(); ++i){
                     axes.push_back(cast_op->axes[i]);
                 }
-                return prod(base->op->get_parents()[0], axes);
+                return prod(base->op->parents_view()[0], axes);
             }
             // Standard
-            Operator op = std::make_shared<op::Product>(g.get(), node, axes);
+            Operator op = make_operator<op::Product>(g.get(), node, axes);
             return g->derived_node(op);
         }
 
@@ -167,16 +167,16 @@ namespace md{
             if(node->data_type != b8){
                 // Node should be b8
                 node = implicit_cast(node, b8, "AllTrue");
-            } else if (base->op->name == "AllTrue") {
+            } else if (base->op->kind == OpKind::AllTrue) {
                 // The all_true(all_true(x,a),b) = all_true(x, a U b)
                 auto cast_op = std::dynamic_pointer_cast<op::AllTrue>(base->op);
                 for(auto i=0; i < cast_op->axes.size(); ++i){
                     axes.push_back(cast_op->axes[i]);
                 }
-                return all_true(base->op->get_parents()[0], axes);
+                return all_true(base->op->parents_view()[0], axes);
             }
             // Standard
-            Operator op = std::make_shared<op::AllTrue>(g.get(), node, axes);
+            Operator op = make_operator<op::AllTrue>(g.get(), node, axes);
             return g->derived_node(op);
         }
 
@@ -209,16 +209,16 @@ namespace md{
             if(node->data_type != b8){
                 // Node should be b8
                 node = implicit_cast(node, b8, "AnyTrue");
-            } else if (base->op->name == "AnyTrue") {
+            } else if (base->op->kind == OpKind::AnyTrue) {
                 // The all_true(all_true(x,a),b) = all_true(x, a U b)
                 auto cast_op = std::dynamic_pointer_cast<op::AnyTrue>(base->op);
                 for(auto i=0; i < cast_op->axes.size(); ++i){
                     axes.push_back(cast_op->axes[i]);
                 }
-                return any_true(base->op->get_parents()[0], axes);
+                return any_true(base->op->parents_view()[0], axes);
             }
             // Standard
-            Operator op = std::make_shared<op::AnyTrue>(g.get(), node, axes);
+            Operator op = make_operator<op::AnyTrue>(g.get(), node, axes);
             return g->derived_node(op);
         }
 
@@ -245,13 +245,13 @@ namespace md{
             // Verify correctness
             Graph g = node.g();
             // Standard
-            Operator op = std::make_shared<op::MaxMinAndArgMaxMin>(g.get(), node, axes, true);
+            Operator op = make_operator<op::MaxMinAndArgMaxMin>(g.get(), node, axes, true);
             auto multi = g->derived_node(op);
             // Max
-            op = std::make_shared<op::MultiOutputIndex>(g.get(), multi, 0);
+            op = make_operator<op::MultiOutputIndex>(g.get(), multi, 0);
             auto max = g->derived_node(op);
             // ArgMax
-            op = std::make_shared<op::MultiOutputIndex>(g.get(), multi, 0);
+            op = make_operator<op::MultiOutputIndex>(g.get(), multi, 0);
             auto arg_max = g->derived_node(op);
             return {max, arg_max};
         };
@@ -271,13 +271,13 @@ namespace md{
             // Verify correctness
             Graph g = node.g();
             // Standard
-            Operator op = std::make_shared<op::MaxMinAndArgMaxMin>(g.get(), node, axes, false);
+            Operator op = make_operator<op::MaxMinAndArgMaxMin>(g.get(), node, axes, false);
             auto multi = g->derived_node(op);
             // Min
-            op = std::make_shared<op::MultiOutputIndex>(g.get(), multi, 0);
+            op = make_operator<op::MultiOutputIndex>(g.get(), multi, 0);
             auto min = g->derived_node(op);
             // ArgMin
-            op = std::make_shared<op::MultiOutputIndex>(g.get(), multi, 0);
+            op = make_operator<op::MultiOutputIndex>(g.get(), multi, 0);
             auto arg_min = g->derived_node(op);
             return {min, arg_min};
         };
@@ -297,13 +297,13 @@ namespace md{
             // Verify correctness
             Graph g = node.g();
             // Standard
-            Operator op = std::make_shared<op::SortAndArgSort>(g.get(), node, axis, ascending);
+            Operator op = make_operator<op::SortAndArgSort>(g.get(), node, axis, ascending);
             auto multi = g->derived_node(op);
             // Sort
-            op = std::make_shared<op::MultiOutputIndex>(g.get(), multi, 0);
+            op = make_operator<op::MultiOutputIndex>(g.get(), multi, 0);
             auto sort = g->derived_node(op);
             // ArgSort
-            op = std::make_shared<op::MultiOutputIndex>(g.get(), multi, 0);
+            op = make_operator<op::MultiOutputIndex>(g.get(), multi, 0);
             auto arg_sort = g->derived_node(op);
             return {sort, arg_sort};
         };
@@ -25,11 +25,11 @@ namespace md{
             }
             // diag(diag(x)) = x, when x is a vector
             auto base = get_base_node(node);
-            if(base->op->name == "Diag" and base.order() == 2){
-                return alias(base->op->get_parents()[0]);
+            if(base->op->kind == OpKind::Diagonal and base.order() == 2){
+                return alias(base->op->parents_view()[0]);
             }
             // Standard
-            Operator op = std::make_shared<op::Diagonal>(g.get(), node);
+            Operator op = make_operator<op::Diagonal>(g.get(), node);
             return g->derived_node(op);
         }
 
@@ -51,16 +51,16 @@ namespace md{
             }
             // diag(diag(x)) = x, when x is a vector
             auto base = get_base_node(node);
-            if(base->op->name == "LowerTriangular"){
+            if(base->op->kind == OpKind::LowerTriangular){
                 auto cast_op = std::dynamic_pointer_cast<op::LowerTriangular>(base->op);
                 if(cast_op->k >= k){
                     return alias(node);
                 } else {
-                    return lower_tri(base->op->get_parents()[0], k);
+                    return lower_tri(base->op->parents_view()[0], k);
                 }
             }
             // Standard
-            Operator op = std::make_shared<op::LowerTriangular>(g.get(), node, k);
+            Operator op = make_operator<op::LowerTriangular>(g.get(), node, k);
             return g->derived_node(op);
         }
 
@@ -82,16 +82,16 @@ namespace md{
             }
             // diag(diag(x)) = x, when x is a vector
             auto base = get_base_node(node);
-            if(base->op->name == "UpperTriangular"){
+            if(base->op->kind == OpKind::UpperTriangular){
                 auto cast_op = std::dynamic_pointer_cast<op::UpperTriangular>(base->op);
                 if(cast_op->k >= k){
                     return alias(node);
                 } else {
-                    return upper_tri(base->op->get_parents()[0], k);
+                    return upper_tri(base->op->parents_view()[0], k);
                 }
             }
             // Standard
-            Operator op = std::make_shared<op::UpperTriangular>(g.get(), node, k);
+            Operator op = make_operator<op::UpperTriangular>(g.get(), node, k);
             return g->derived_node(op);
         }
 
@@ -112,11 +112,11 @@ namespace md{
             }
             // The reshape(reshape(x)) = reshape(x)
             auto base = get_base_node(node);
-            if(base->op->name == "Reshape"){
-                return reshape(base->op->get_parents()[0], shape);
+            if(base->op->kind == OpKind::Reshape){
+                return reshape(base->op->parents_view()[0], shape);
             }
             // Standard
-            Operator op = std::make_shared<op::Reshape>(g.get(), node, shape);
+            Operator op = make_operator<op::Reshape>(g.get(), node, shape);
             return g->derived_node(op);
         }
 
@@ -162,7 +162,7 @@ namespace md{
             }
             // The reorder(reorder(x)) = reorder(x) with some specifics
             auto base = get_base_node(node);
-            if(base->op->name == "Reorder"){
+            if(base->op->kind == OpKind::Reorder){
                 std::shared_ptr<const op::Reorder> cast_op = std::dynamic_pointer_cast<const op::Reorder>(base->op);
                 Axes original_order = {0, 1, 2, 3};
                 for(auto i=0; i < cast_op->order.size(); ++i){
@@ -184,11 +184,11 @@ namespace md{
                     return alias(node);
                 }
                 // Standard
-                Operator op = std::make_shared<op::Reorder>(g.get(), base, order);
+                Operator op = make_operator<op::Reorder>(g.get(), base, order);
                 return g->derived_node(op);
             }
             // Standard
-            Operator op = std::make_shared<op::Reorder>(g.get(), node, order);
+            Operator op = make_operator<op::Reorder>(g.get(), node, order);
             return g->derived_node(op);
         }
 
@@ -229,7 +229,7 @@ namespace md{
             }
             Graph g = node.g();
             // TODO check if parent is flip as well
-            Operator op = std::make_shared<op::Flip>(g.get(), node, axes);
+            Operator op = make_operator<op::Flip>(g.get(), node, axes);
             return g->derived_node(op);
         }
 
@@ -14,14 +14,14 @@ namespace md{
                 return alias(node);
             }
             // Standard
-            Operator op = std::make_shared<op::Cast>(g.get(), node, data_type);
+            Operator op = make_operator<op::Cast>(g.get(), node, data_type);
             return g->derived_node(op);
         }
 
         Node alias(Node node) {
             Graph g = node.g();
             // Standard
-            Operator op = std::make_shared<op::Alias>(g.get(), node);
+            Operator op = make_operator<op::Alias>(g.get(), node);
             return g->derived_node(op);
         }
 
@@ -41,8 +41,18 @@ namespace md{
                                                   " to shape " + to_string(shape));
                 }
             }
+            auto base = get_base_node(node);
+            // Broadcasting a constant is the same constant with the new shape
+            if(base->op->kind == OpKind::ConstantValue){
+                auto cast_op = std::dynamic_pointer_cast<op::ConstantValue>(base->op);
+                return g->constant(cast_op->value, base->data_type, shape);
+            }
+            // Broadcasting a broadcast is the same as broadcasting its parent
+            if(base->op->kind == OpKind::Broadcast){
+                return broadcast(base->op->parents_view()[0], shape);
+            }
             // Standard
-            Operator op = std::make_shared<op::Broadcast>(g.get(), node, shape);
+            Operator op = make_operator<op::Broadcast>(g.get(), node, shape);
             return g->derived_node(op);
         }
 
@@ -53,7 +63,7 @@ namespace md{
                 return alias(node);
             }
             // Standard
-            Operator op = std::make_shared<op::MakeConstant>(g.get(), node);
+            Operator op = make_operator<op::MakeConstant>(g.get(), node);
             return g->derived_node(op);
         }
 
@@ -64,11 +74,11 @@ namespace md{
                 throw InvalidOperatorArgument(NodeVec{shared, update}, "Update",
                                               "Shared and update are not part of the same graph.");
             }
-            // Check that shared is a SharedInput
-            if(shared->op->name != "SharedInput"){
-                op_logger("Update")->error("The variable provided for updating is not a SharedInput.");
+            // Check that shared is a Parameter
+            if(shared->op->kind != OpKind::Parameter){
+                op_logger("Update")->error("The variable provided for updating is not a Parameter.");
                 throw InvalidOperatorArgument(NodeVec{shared, update}, "Update",
-                                              "The variable provided for updating is not a SharedInput.");
+                                              "The variable provided for updating is not a Parameter.");
             }
             // Check that Shared does not already have an update
             if(g->updates.find(shared) != g->updates.end()){
@@ -103,8 +113,42 @@ namespace md{
             NodeVec corrected = {condition, if_true, if_false};
             verify_shapes_and_broadcast(corrected, op_name);
             // Standard
-            Operator op = std::make_shared<op::Select>(g.get(), corrected[0], corrected[1], corrected[2]);
+            Operator op = make_operator<op::Select>(g.get(), corrected[0], corrected[1], corrected[2]);
             return g->derived_node(op);
         }
+
+        NodeVec call(SubRoutinePtr body, NodeVec args){
+            NodeVec const & inputs = body->function.inputs;
+            if(args.size() != inputs.size() or args.empty()){
+                op_logger("SubRoutine")->error("The subroutine {} expects {} arguments, but was called with {}.",
+                                               body->name, inputs.size(), args.size());
+                throw InvalidOperatorArgument(args, "SubRoutine", "The subroutine " + body->name + " expects " +
+                        std::to_string(inputs.size()) + " arguments, but was called with " +
+                        std::to_string(args.size()) + ".");
+            }
+            Graph g = args[0].g();
+            for(auto i = 0; i < args.size(); ++i){
+                if(args[i].g() != g){
+                    op_logger("SubRoutine")->error("The arguments of the subroutine {} are not all from the same graph.",
+                                                   body->name);
+                    throw InvalidOperatorArgument(args, "SubRoutine", "The arguments of the subroutine " + body->name +
+                            " are not all from the same graph.");
+                }
+                // The shapes are interned in different graphs, hence are compared by value
+                if(args[i]->shape != Shape(inputs[i]->shape) or args[i]->data_type != inputs[i]->data_type){
+                    op_logger("SubRoutine")->error("The argument {} of the subroutine {} has shape {}, "
+                                                           "while the input expects {}.", i, body->name,
+                                                   to_string(args[i]->shape), to_string(inputs[i]->shape));
+                    throw InvalidOperatorArgument(args, "SubRoutine", "The argument " + std::to_string(i) +
+                            " of the subroutine " + body->name + " does not match the input.");
+                }
+            }
+            NodeVec outputs;
+            for(auto i = 0; i < body->function.outputs.size(); ++i){
+                Operator op = make_operator<op::SubRoutine>(g.get(), body, args, i);
+                outputs.push_back(g->derived_node(op));
+            }
+            return outputs;
+        }
     }
 }
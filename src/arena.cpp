@@ -0,0 +1,60 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#include "graph_ir.h"
+
+namespace md{
+    namespace gir{
+        MonotonicArena::MonotonicArena():
+                current(nullptr),
+                end(nullptr),
+                reserved_bytes(0) {
+            pools.fill(nullptr);
+        }
+
+        MonotonicArena::~MonotonicArena() {
+            for (auto block: blocks) {
+                ::operator delete(block);
+            }
+        }
+
+        void * MonotonicArena::allocate(size_t const bytes) {
+            size_t const size = round_up(bytes == 0 ? 1 : bytes);
+            if (size <= max_pooled) {
+                void * & pool = pools[size / granularity - 1];
+                if (pool != nullptr) {
+                    void * const ptr = pool;
+                    pool = *static_cast<void**>(ptr);
+                    return ptr;
+                }
+            }
+            if (size > block_size / 4) {
+                // Large allocations get their own block, so that they do not waste the current one
+                char * const block = static_cast<char*>(::operator new(size));
+                blocks.push_back(block);
+                reserved_bytes += size;
+                return block;
+            }
+            if (current == nullptr or static_cast<size_t>(end - current) < size) {
+                current = static_cast<char*>(::operator new(block_size));
+                end = current + block_size;
+                blocks.push_back(current);
+                reserved_bytes += block_size;
+            }
+            void * const ptr = current;
+            current += size;
+            return ptr;
+        }
+
+        void MonotonicArena::deallocate(void * const ptr, size_t const bytes) {
+            size_t const size = round_up(bytes == 0 ? 1 : bytes);
+            if (ptr == nullptr or size > max_pooled) {
+                return;
+            }
+            void * & pool = pools[size / granularity - 1];
+            *static_cast<void**>(ptr) = pool;
+            pool = ptr;
+        }
+    }
+}
@@ -0,0 +1,281 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#include "graph_ir.h"
+
+namespace md{
+    namespace gir{
+        namespace {
+            /** Returns the shape with the size of the batch along the batch axis */
+            Shape batched_shape(Shape shape, int const axis, SymInt const batch_size){
+                shape[axis] = batch_size;
+                return shape;
+            }
+
+            /** Removes the batch axis from reduction axes of an operator of the function.
+             * The batch axis has size 1 in the function, so reducing along it does nothing and it is either dropped
+             * or replaced by another axis of size 1, since an empty list of axes means something else.
+             * Returns false if there is no such axis.
+             */
+            bool unbatch_axes(Axes & axes, int const axis, Shape const & shape){
+                auto it = std::find(axes.begin(), axes.end(), axis);
+                if(it == axes.end()){
+                    return true;
+                }
+                if(axes.size() > 1){
+                    axes.erase(it);
+                    return true;
+                }
+                for(auto i = 0; i < 4; ++i){
+                    if(i != axis and shape[i] == 1){
+                        *it = i;
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            /** Returns the batched matrix reshaped, such that the batch is along axis 2 */
+            Node normalize_matrix(Node node, Shape const & shape, SymInt const batch_size){
+                return api::reshape(node, {shape[0], shape[1], batch_size, 1});
+            }
+
+            /** Returns the product of the matrices, where the batched ones are normalized (see normalize_matrix()).
+             * A batched matrix multiplied by a shared one is folded into a single matrix, with the batch
+             * flattened into its columns, only two batched matrices are multiplied elementwise and summed.
+             */
+            Node batched_matrix_mul(NodeVec const & nodes, std::vector<bool> const & t, std::vector<bool> const & batched){
+                Axes const transpose_order = {1, 0, 2, 3};
+                Node result = nodes[0];
+                bool result_t = t[0];
+                bool result_batched = batched[0];
+                if(result_batched and result_t){
+                    result = api::reorder(result, transpose_order);
+                    result_t = false;
+                }
+                for(auto i = 1; i < nodes.size(); ++i){
+                    Node right = nodes[i];
+                    bool right_t = t[i];
+                    if(batched[i] and right_t){
+                        right = api::reorder(right, transpose_order);
+                        right_t = false;
+                    }
+                    if(not result_batched and not batched[i]){
+                        result = api::matrix_mul(NodeVec{result, right}, {result_t, right_t});
+                    } else if(not result_batched){
+                        // A [B_1, ..., B_k] = [A B_1, ..., A B_k]
+                        Shape const shape = right->shape;
+                        Node const flat = api::reshape(right, {shape[0], shape[1] * shape[2], 1, 1});
+                        Node const product = api::matrix_mul(NodeVec{result, flat}, {result_t, false});
+                        result = api::reshape(product, {product->shape[0], shape[1], shape[2], 1});
+                    } else if(not batched[i]){
+                        // A_k B = (B^T A_k^T)^T
+                        Node const left = api::reorder(result, transpose_order);
+                        Shape const shape = left->shape;
+                        Node const flat = api::reshape(left, {shape[0], shape[1] * shape[2], 1, 1});
+                        Node const product = api::matrix_mul(NodeVec{right, flat}, {not right_t, false});
+                        result = api::reorder(api::reshape(product, {product->shape[0], shape[1], shape[2], 1}),
+                                              transpose_order);
+                    } else {
+                        // The shared dimension is moved to axis 2 and the batch to axis 3
+                        Node const left = api::reorder(result, {0, 3, 1, 2});
+                        right = api::reorder(right, {3, 1, 0, 2});
+                        Shape const full = {left->shape[0], right->shape[1], left->shape[2], left->shape[3]};
+                        Node const product = api::sum(api::mul(api::broadcast(left, full),
+                                                               api::broadcast(right, full)), 2);
+                        result = api::reorder(product, {0, 1, 3, 2});
+                    }
+                    result_t = false;
+                    result_batched = result_batched or batched[i];
+                }
+                return result;
+            }
+        }
+
+        int GraphFunction::batch_axis() const {
+            int axis = 0;
+            for(auto i: graph->get_ancestors_mask(outputs)){
+                Shape const shape = graph->nodes[i]->shape;
+                for(auto j = 3; j >= axis; --j){
+                    if(shape[j] != 1){
+                        axis = j + 1;
+                        break;
+                    }
+                }
+            }
+            return axis < 4 ? axis : -1;
+        }
+
+        std::vector<Node> GraphFunction::apply_batched(Graph other_graph, std::vector<Node> provided_inputs) {
+            if(provided_inputs.size() != inputs.size()){
+                g_logger(other_graph->name)->error("Incorrect number of provided inputs");
+                throw InternalGraphError("FunctionApplyBatched", "Incorrect number of provided inputs");
+            }
+            int const axis = batch_axis();
+            if(axis < 0){
+                g_logger(other_graph->name)->error("The function {} uses all axes, "
+                                                           "hence there is no axis for the batch.", name);
+                throw InternalGraphError("FunctionApplyBatched", "The function " + name + " uses all axes, "
+                        "hence there is no axis for the batch.");
+            }
+            auto const mask = graph->get_ancestors_mask(outputs);
+            // Which of the nodes of the function are batched, starting from the inputs
+            std::vector<bool> batched(graph->nodes.size(), false);
+            SymInt batch_size = 1;
+            bool has_batch = false;
+            for(auto i = 0; i < inputs.size(); ++i){
+                Shape const shape = inputs[i]->shape;
+                Shape const provided_shape = provided_inputs[i]->shape;
+                if(provided_inputs[i].graph != other_graph.get()){
+                    g_logger(other_graph->name)->error("The provided input {} is not part of the graph.", i);
+                    throw InternalGraphError("FunctionApplyBatched", "The provided input " + std::to_string(i)
+                                                                     + " is not part of the graph.");
+                } else if(provided_shape == shape){
+                    continue;
+                } else if(provided_shape != batched_shape(shape, axis, provided_shape[axis])
+                          or (has_batch and provided_shape[axis] != batch_size)){
+                    auto const msg = fmt::format("The provided input {} has shape {}, which is neither the shape "
+                                                         "of the input {} nor batched along axis {}.",
+                                                 i, to_string(provided_shape), to_string(shape), axis);
+                    g_logger(other_graph->name)->error(msg);
+                    throw InternalGraphError("FunctionApplyBatched", msg);
+                }
+                batch_size = provided_shape[axis];
+                has_batch = true;
+                batched[inputs[i].id] = true;
+            }
+            // The nodes which do not depend on any input are shared by all examples, hence are the same as
+            // in the function, when applied to the same graph, and copied only once otherwise.
+            // In the same graph the inputs which are provided as they are do not change anything either.
+            NodeVec replaced;
+            for(auto i = 0; i < inputs.size(); ++i){
+                if(other_graph != graph or provided_inputs[i].id != inputs[i].id){
+                    replaced.push_back(inputs[i]);
+                }
+            }
+            auto const dependent = graph->get_descendants_mask(replaced);
+            NodeSet invariant(graph->nodes.size());
+            for(auto i: mask){
+                if(not dependent[i]){
+                    invariant.insert(i);
+                }
+            }
+            IdRemap remap;
+            if(other_graph == graph){
+                remap = IdRemap(graph.get(), graph->nodes.size());
+                for(auto i: invariant){
+                    remap.set(i, i);
+                }
+            } else {
+                remap = graph->remap_into(other_graph, invariant, Updates{}, false, true, false);
+            }
+            for(auto i = 0; i < inputs.size(); ++i){
+                remap.set(inputs[i].id, provided_inputs[i].id);
+            }
+            NodeVec new_ancestors;
+            for(auto i: mask){
+                if(remap.contains(i)){
+                    continue;
+                }
+                // Only the operator and the ids of the ancestors are kept,
+                // since applying to the same graph may move the nodes
+                NodeData const * const data = graph->nodes.data(i);
+                Operator const op = data->op;
+                std::string const node_name = data->name;
+                auto const ancestors_view = graph->edges.ancestors(i);
+                std::vector<size_t> const ancestors(ancestors_view.begin(), ancestors_view.end());
+                bool is_batched = false;
+                new_ancestors.clear();
+                for(auto j: ancestors){
+                    is_batched = is_batched or batched[j];
+                    new_ancestors.push_back(remap.node(j));
+                }
+                Node result;
+                if(not is_batched){
+                    result = other_graph->derived_node(op->copy_to(other_graph.get(), new_ancestors), node_name);
+                } else {
+                    Shape const shape = graph->nodes[i]->shape;
+                    if(op->kind == OpKind::MatrixMul){
+                        auto cast_op = std::dynamic_pointer_cast<const op::MatrixMul>(op);
+                        std::vector<bool> ancestors_batched;
+                        for(auto j = 0; j < ancestors.size(); ++j){
+                            ancestors_batched.push_back(batched[ancestors[j]]);
+                            if(batched[ancestors[j]]){
+                                new_ancestors[j] = normalize_matrix(new_ancestors[j],
+                                                                    graph->nodes[ancestors[j]]->shape, batch_size);
+                            }
+                        }
+                        result = api::reshape(batched_matrix_mul(new_ancestors, cast_op->t, ancestors_batched),
+                                              batched_shape(shape, axis, batch_size));
+                    } else if(op->kind == OpKind::Reshape){
+                        auto cast_op = std::dynamic_pointer_cast<const op::Reshape>(op);
+                        result = other_graph->derived_node(make_operator<op::Reshape>(
+                                other_graph.get(), new_ancestors[0], batched_shape(cast_op->shape, axis, batch_size)),
+                                                           node_name);
+                    } else if(op->kind == OpKind::Broadcast){
+                        auto cast_op = std::dynamic_pointer_cast<const op::Broadcast>(op);
+                        result = other_graph->derived_node(make_operator<op::Broadcast>(
+                                other_graph.get(), new_ancestors[0], batched_shape(cast_op->to_shape, axis, batch_size)),
+                                                           node_name);
+                    } else if(op->kind == OpKind::Reorder){
+                        // The batch axis stays in place, it is swapped with whichever axis of size 1 took its place
+                        Axes order = std::dynamic_pointer_cast<const op::Reorder>(op)->order;
+                        for(auto j = order.size(); j < 4; ++j){
+                            order.push_back(static_cast<int>(j));
+                        }
+                        std::swap(*std::find(order.begin(), order.end(), axis), order[axis]);
+                        result = other_graph->derived_node(make_operator<op::Reorder>(
+                                other_graph.get(), new_ancestors[0], order), node_name);
+                    } else if(op->kind == OpKind::Flip){
+                        Axes axes = std::dynamic_pointer_cast<const op::Flip>(op)->axes;
+                        axes.erase(std::remove(axes.begin(), axes.end(), axis), axes.end());
+                        result = api::flip(new_ancestors[0], axes);
+                    } else if(std::dynamic_pointer_cast<const op::ReductionOperator>(op) or
+                              op->kind == OpKind::Softmax){
+                        // The copy is not yet part of the graph, so its axes can still be changed
+                        Operator new_op = op->copy_to(other_graph.get(), new_ancestors);
+                        Shape const parent_shape = graph->nodes[ancestors[0]]->shape;
+                        auto reduction = std::dynamic_pointer_cast<op::ReductionOperator>(new_op);
+                        Axes & axes = reduction ? reduction->axes :
+                                      std::dynamic_pointer_cast<op::Softmax>(new_op)->axes;
+                        if(not unbatch_axes(axes, axis, parent_shape)){
+                            auto const msg = fmt::format("Can not batch the {} of node {} along axis {}.",
+                                                         op->name, i, axis);
+                            g_logger(other_graph->name)->error(msg);
+                            throw InternalGraphError("FunctionApplyBatched", msg);
+                        }
+                        result = other_graph->derived_node(new_op, node_name);
+                    } else if(std::dynamic_pointer_cast<const op::ElementwiseOperator>(op) and
+                              op->kind != OpKind::CategoricalCrossEntropyLogits){
+                        // The shared ancestors are broadcasted to the whole batch
+                        for(auto j = 0; j < ancestors.size(); ++j){
+                            if(not batched[ancestors[j]]){
+                                new_ancestors[j] = api::broadcast(new_ancestors[j], batched_shape(
+                                        graph->nodes[ancestors[j]]->shape, axis, batch_size));
+                            }
+                        }
+                        result = other_graph->derived_node(op->copy_to(other_graph.get(), new_ancestors), node_name);
+                    } else {
+                        auto const msg = fmt::format("The operator {} of node {} can not be batched.", op->name, i);
+                        g_logger(other_graph->name)->error(msg);
+                        throw InternalGraphError("FunctionApplyBatched", msg);
+                    }
+                    batched[i] = true;
+                }
+                remap.set(i, result.id);
+            }
+            std::vector<Node> result;
+            for(auto i = 0; i < outputs.size(); ++i){
+                Node const output = remap.node(outputs[i].id);
+                if(batched[outputs[i].id] or not has_batch){
+                    result.push_back(output);
+                } else {
+                    // Outputs which do not depend on the batch are the same for all examples
+                    result.push_back(api::broadcast(output, batched_shape(outputs[i]->shape, axis, batch_size)));
+                }
+            }
+            return result;
+        }
+    }
+}
@@ -0,0 +1,120 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#include "graph_ir.h"
+
+namespace md{
+    namespace gir{
+        GraphBuilder::GraphBuilder(Graph const target, std::string const name):
+                graph(api::create_graph()),
+                target(target) {
+            graph->name = name;
+            graph->props = target->props;
+            graph->scope = graph->scopes.import(target->scopes, target->scope, target->props.scope_delimiter);
+            graph->grad_level = target->grad_level;
+        }
+
+        Node GraphBuilder::import(Node const node) {
+            if(node.g() != target){
+                g_logger(graph->name)->error("Importing node {} which is not part of the target graph {}.",
+                                             node.id, target->name);
+                throw InternalGraphError("Import", "Importing node " + std::to_string(node.id) +
+                                                   " which is not part of the target graph " + target->name + ".");
+            }
+            auto it = placeholders.find(node.id);
+            if(it != placeholders.end()){
+                return it->second;
+            }
+            // Constants are copied instead, so that their values can still be folded in the builder
+            Node const placeholder = std::dynamic_pointer_cast<const op::ConstantOperator>(node->op) ?
+                                     graph->derived_node(node->op->copy_to(graph.get(), NodeVec{}), node->name) :
+                                     graph->tensor4(node->data_type, node->shape, node->name);
+            placeholders[node.id] = placeholder;
+            imported[placeholder] = node;
+            return placeholder;
+        }
+
+        IdRemap GraphBuilder::import_copies(NodeSet const & mask) {
+            Updates provided;
+            for(auto i: mask){
+                for(auto ancestor: target->edges.ancestors(i)){
+                    if(not mask[ancestor]){
+                        Node const parent = target->nodes[ancestor];
+                        provided[parent] = import(parent);
+                    }
+                }
+            }
+            IdRemap remap = target->remap_into(graph, mask, provided, true, true, false);
+            for(auto i: mask){
+                Node const copy = remap.node(i);
+                placeholders[i] = copy;
+                imported[copy] = target->nodes[i];
+            }
+            return remap;
+        }
+
+        Updates GraphBuilder::merge_into() const {
+            NodeSet all(graph->nodes.size(), true);
+            return graph->copy_into(target, all, imported, true, true, true);
+        }
+
+        Updates GraphBuilder::merge_into(NodeVec const & outputs) const {
+            return graph->copy_into(target, graph->get_ancestors_mask(outputs), imported, true, true, false);
+        }
+
+        std::vector<NodeVec> build_concurrently(Graph const graph, size_t const n,
+                                                BuildFunction const build, size_t threads){
+            if(threads == 0){
+                threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+            }
+            threads = std::min(threads, n);
+            // The builders are created upfront, so that none of them reads the target while it is modified
+            std::vector<std::unique_ptr<GraphBuilder>> builders;
+            for(size_t i = 0; i < n; ++i){
+                builders.emplace_back(new GraphBuilder(graph, graph->name + "_builder" + std::to_string(i)));
+            }
+            std::vector<NodeVec> built(n);
+            std::vector<std::exception_ptr> errors(n);
+            std::atomic<size_t> next(0);
+            auto worker = [&]() {
+                for(size_t i = next++; i < n; i = next++){
+                    try {
+                        built[i] = build(*builders[i], i);
+                    } catch (...) {
+                        errors[i] = std::current_exception();
+                    }
+                }
+            };
+            std::vector<std::thread> pool;
+            for(size_t t = 1; t < threads; ++t){
+                pool.emplace_back(worker);
+            }
+            worker();
+            for(auto & thread: pool){
+                thread.join();
+            }
+            for(size_t i = 0; i < n; ++i){
+                if(errors[i]){
+                    std::rethrow_exception(errors[i]);
+                }
+            }
+            // Merge in the order of the index, which makes the ids deterministic
+            std::vector<NodeVec> results(n);
+            for(size_t i = 0; i < n; ++i){
+                auto mapping = builders[i]->merge_into();
+                for(auto const & node: built[i]){
+                    if(node.g() != builders[i]->graph){
+                        g_logger(graph->name)->error("The build function for index {} returned a node "
+                                                             "which is not part of its builder.", i);
+                        throw InternalGraphError("BuildConcurrently", "The build function for index " +
+                                                                      std::to_string(i) + " returned a node "
+                                                                      "which is not part of its builder.");
+                    }
+                    results[i].push_back(mapping[node]);
+                }
+            }
+            return results;
+        }
+    }
+}
@@ -0,0 +1,43 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#include "graph_ir.h"
+
+namespace md{
+    namespace gir{
+        void EdgeIndex::append(NodeView const ancestors){
+            size_t const id = size();
+            for(auto i = 0; i < ancestors.size(); ++i){
+                ancestors_ids.push_back(ancestors[i].id);
+                children_ids[ancestors[i].id].push_back(id);
+            }
+            ancestors_offsets.push_back(ancestors_ids.size());
+            children_ids.emplace_back();
+        }
+
+        void EdgeIndex::clear(){
+            ancestors_offsets.assign(1, 0);
+            ancestors_ids.clear();
+            children_ids.clear();
+        }
+
+        void EdgeIndex::truncate(size_t const n){
+            if(n >= size()){
+                return;
+            }
+            // The removed nodes are the newest children of their ancestors, hence removing them in reverse
+            // finds each at the back of the lists
+            for(auto i = size(); i-- > n;){
+                for(auto j = ancestors_offsets[i + 1]; j-- > ancestors_offsets[i];){
+                    if(ancestors_ids[j] < n){
+                        children_ids[ancestors_ids[j]].pop_back();
+                    }
+                }
+            }
+            ancestors_ids.resize(ancestors_offsets[n]);
+            ancestors_offsets.resize(n + 1);
+            children_ids.resize(n);
+        }
+    }
+}
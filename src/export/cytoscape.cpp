@@ -49,12 +49,13 @@ namespace md{
             for(auto i=0; i < g->nodes.size(); ++i) {
                 auto node = g->nodes[i];
                 std::string parent_name = "Grads_0";
-                if(node->scope != ""){
-                    parent_name = clear_full_name(node->scope + "_" + std::to_string(node->grad_level));
+                if(node->scope != ScopeTable::root){
+                    parent_name = clear_full_name(g->scopes.full_name(node->scope) + "_" +
+                                                  std::to_string(node->grad_level));
                     groups.insert(parent_name);
                 }
-                auto parents = node->op->get_parents();
-                auto children = node->children;
+                auto const parents = node->op->parents_view();
+                auto const children = g->edges.children(node.id);
                 for (auto j = 0; j < parents.size(); ++j) {
                     edges.push_back({parents[j]->id, node->id});
                 }
@@ -80,9 +81,9 @@ namespace md{
                   << "    Children: '[";
                 for(auto j=0; j<children.size(); ++j){
                     if(j == children.size() - 1){
-                        s << children[j]->id;
+                        s << children[j];
                     } else {
-                        s << children[j]->id << ", ";
+                        s << children[j] << ", ";
                     }
                 }
                 s << "]'," << std::endl
@@ -79,7 +79,7 @@ namespace md{
 //            writer.EndObject();
 //        }
 
-        void export_nodes(std::vector<std::shared_ptr<NodeData>> const & nodes,
+        void export_nodes(NodeArena const & nodes,
                           PrettyWriter<StringBuffer>& writer){
             writer.StartArray();
             for(auto i=0; i<nodes.size(); ++i){
@@ -93,7 +93,7 @@ namespace md{
                 writer.String("grad_level");
                 writer.Uint(nodes[i]->grad_level);
                 writer.String("scope");
-                writer.String(nodes[i]->scope);
+                writer.String(nodes[i]->graph->scopes.full_name(nodes[i]->scope));
 //                writer.String("execution_data");
 //                export_execution_data(nodes[i]->execution, writer);
                 writer.EndObject();
@@ -102,8 +102,8 @@ namespace md{
         }
 
         void export_op(Operator const op,  PrettyWriter<StringBuffer>& writer){
-            auto parents = op->get_parents();
-            auto arguments = op->get_arguments();
+            auto const parents = op->parents_view();
+            auto const arguments = op->arguments_view();
             writer.StartObject();
             writer.String("name");
             writer.String(op->name);
@@ -11,20 +11,23 @@ namespace md{
                                      std::vector<Node> const inputs,
                                      std::vector<Node> const outputs,
                                      Updates extra_updates,
-                                     bool copy_updates):
+                                     bool copy_updates,
+                                     bool as_view):
                 GraphFunction(full_graph->name,
                               std::move(full_graph),
                               std::move(inputs),
                               std::move(outputs),
                               std::move(extra_updates),
-                              copy_updates) {};
+                              copy_updates,
+                              as_view) {};
 
         GraphFunction::GraphFunction(std::string const name,
                                      Graph const full_graph,
                                      std::vector<Node> const inputs,
                                      std::vector<Node> const outputs,
                                      Updates extra_updates,
-                                     bool copy_updates): name(name) {
+                                     bool copy_updates,
+                                     bool as_view): name(name) {
             std::vector<Node> leafs = outputs;
             // Add the inputs to the leafs
             leafs.insert(leafs.end(), inputs.begin(), inputs.end());
@@ -40,34 +43,110 @@ namespace md{
             // Get ancestor mask of all of the outputs
             auto ancestor_mask = full_graph->get_ancestors_mask(leafs);
             // Check that all of the inputs are provided
-            auto all_inputs = full_graph->op_map["Input"];
+            auto all_inputs = full_graph->op_map[OpKind::Input];
             for(auto i=0; i<all_inputs.size(); ++i){
                 if(ancestor_mask[all_inputs[i]->id]) {
-                    auto r = std::find_if(inputs.begin(), inputs.end(), [=](const Node &n) { return n->id == i;});
+                    auto const id = all_inputs[i]->id;
+                    auto r = std::find_if(inputs.begin(), inputs.end(), [=](const Node &n) { return n->id == id;});
                     if (r == inputs.end()) {
                         g_logger(full_graph->name)->error(
                                 "The outputs requested require the input {} which has not been provided",
-                                to_string(full_graph->nodes[i]));
+                                to_string(all_inputs[i]));
                         throw InvalidOperatorArgument(NodeVec{}, "MakeFunction",
                                                       "The outputs requested require the input " +
-                                                      to_string(full_graph->nodes[i]) + " which has not been provided.");
+                                                      to_string(all_inputs[i]) + " which has not been provided.");
                     }
                 }
             }
-            graph = api::create_graph();
-            auto mapping = full_graph->copy_into(graph, ancestor_mask, Updates{}, true, true, copy_updates);
+            // The function starts as a view of the ancestors
+            graph = full_graph;
+            members = std::move(ancestor_mask);
+            view = true;
+            node_ids.reserve(members.count());
+            for(auto i: members){
+                node_ids.push_back(i);
+            }
+            if(copy_updates){
+                updates = full_graph->updates;
+            }
+            this->inputs = inputs;
+            this->outputs = outputs;
+            unique_symbolics = unique_dimensions(graph, members);
+            // Extra updates can not be added to the original graph, hence they require a copy
+            if(not as_view or not extra_updates.empty()){
+                materialize(extra_updates);
+            }
+        }
+
+        NodeVec GraphFunction::nodes() const {
+            NodeVec result;
+            result.reserve(node_ids.size());
+            for(auto i=0; i<node_ids.size(); ++i){
+                result.push_back(graph->nodes[node_ids[i]]);
+            }
+            return result;
+        }
+
+        NodeVec GraphFunction::op_nodes(OpKind const kind) const {
+            NodeVec result;
+            auto it = graph->op_map.find(kind);
+            if(it != graph->op_map.end()){
+                for(auto i=0; i<it->second.size(); ++i){
+                    if(members[it->second[i]->id]){
+                        result.push_back(it->second[i]);
+                    }
+                }
+            }
+            return result;
+        }
+
+        size_t GraphFunction::local_id(Node const node) const {
+            auto it = std::lower_bound(node_ids.begin(), node_ids.end(), node->id);
+            if(node.g() != graph or it == node_ids.end() or *it != node->id){
+                g_logger(graph->name)->error("The node {} is not part of the function {}", to_string(node), name);
+                throw InternalGraphError("FunctionLocalId", "The node " + to_string(node)
+                                                            + " is not part of the function " + name + ".");
+            }
+            return static_cast<size_t>(it - node_ids.begin());
+        }
+
+        void GraphFunction::materialize() {
+            materialize(Updates{});
+        }
+
+        void GraphFunction::materialize(Updates const & extra_updates) {
+            if(not view){
+                return;
+            }
+            auto new_graph = api::create_graph();
+            auto remap = graph->remap_into(new_graph, members, Updates{}, true, true, false);
+            for(auto it=updates.begin(); it != updates.end();  ++it){
+                api::update(remap.node(it->first.id), remap.node(it->second.id));
+            }
             // Add the extra updates
             for(auto it=extra_updates.begin(); it != extra_updates.end();  ++it){
-                api::update(mapping[it->first], mapping[it->second]);
+                api::update(remap.node(it->first.id), remap.node(it->second.id));
             }
             // Convert outputs and inputs
             for(auto i=0; i<outputs.size(); ++i){
-                this->outputs.push_back(mapping[outputs[i]]);
+                outputs[i] = remap.node(outputs[i].id);
             }
-            for(auto i=0; i<outputs.size(); ++i){
-                this->inputs.push_back(mapping[inputs[i]]);
+            for(auto i=0; i<inputs.size(); ++i){
+                inputs[i] = remap.node(inputs[i].id);
+            }
+            // Equal nodes may be merged while copying, hence the members are the nodes they were mapped to
+            NodeSet new_members(new_graph->nodes.size());
+            for(auto i: members){
+                new_members.insert(remap[i]);
             }
-            unique_symbolics = unique_dimensions(graph);
+            graph = new_graph;
+            updates = graph->updates;
+            members = std::move(new_members);
+            node_ids.clear();
+            for(auto i: members){
+                node_ids.push_back(i);
+            }
+            view = false;
         }
 
         std::vector<Node> GraphFunction::apply(Graph other_graph, std::vector<Node> provided_inputs,
@@ -76,9 +155,9 @@ namespace md{
                 g_logger(other_graph->name)->error("Incorrect number of provided inputs");
                 throw InternalGraphError("FunctionApply", "Incorrect number of provided inputs");
             }
-            std::vector<bool> flow_tree;
+            NodeSet flow_tree;
             if(apply_updates){
-                flow_tree = std::vector<bool>(graph->nodes.size(), true);
+                flow_tree = members;
             } else {
                 flow_tree = graph->get_flow_tree_mask(inputs, outputs);
             }
@@ -86,12 +165,18 @@ namespace md{
             for(auto i=0; i<inputs.size(); ++i){
                 provided[inputs[i]] = provided_inputs[i];
             }
-            auto mapping = graph->apply(other_graph, flow_tree, provided, false, apply_updates);
-            std::vector<Node> outputs;
+            auto remap = graph->remap_into(other_graph, flow_tree, provided, false, apply_updates, false);
+            // The updates of the original graph may not be part of a view, so only those of the function are applied
+            if(apply_updates){
+                for(auto it=updates.begin(); it != updates.end();  ++it){
+                    api::update(remap.node(it->first.id), remap.node(it->second.id));
+                }
+            }
+            std::vector<Node> result;
             for(auto i=0; i<outputs.size(); ++i){
-                outputs.push_back(mapping[outputs[i]]);
+                result.push_back(remap.node(outputs[i].id));
             }
-            return outputs;
+            return result;
         }
 
 
@@ -111,176 +196,497 @@ namespace md{
             }
         }
 
-        Updates GraphInternal::copy_into(Graph new_graph, std::vector<bool> const & mask,
+        Updates GraphInternal::copy_into(Graph new_graph, NodeSet const & mask,
                                          Updates const & provided,
                                          bool allow_input_copies, bool allow_parameter_copies,
                                          bool copy_updates) const {
+            return remap_into(new_graph, mask, provided, allow_input_copies, allow_parameter_copies,
+                              copy_updates).to_updates(const_cast<GraphInPtr>(this));
+        }
+
+        IdRemap GraphInternal::remap_into(Graph new_graph, NodeSet const & mask,
+                                          Updates const & provided,
+                                          bool allow_input_copies, bool allow_parameter_copies,
+                                          bool copy_updates) const {
             // Verify that the left nodes in the mapped are from this graph and the right are from the new
+            IdRemap remap(new_graph.get(), nodes.size());
             for(auto it = provided.begin(); it != provided.end(); ++it){
-                if(it->first.g().get() != this){
+                if(it->first.graph != this){
                     g_logger(name)->error("A source node from the provided nodes is not part of this graph.");
                     throw InternalGraphError("CopyInto", "A source node from the provided nodes is not part of this graph.");
-                } else if(it->second.g() != new_graph){
+                } else if(it->second.graph != new_graph.get()){
                     g_logger(name)->error("A target node from the provided nodes is not part of this graph.");
                     throw InternalGraphError("CopyInto", "A target node from the provided nodes is not part of this graph.");
                 }
+                remap.set(it->first.id, it->second.id);
             }
             g_logger(name)->trace("Copying into graph {}", new_graph->name);
-            size_t n = nodes.size();
-            // Variable which maps each node (by id) of the original graph to a Node in the new graph
-            Updates mapping;
-            // Copy nodes
-            for (auto i = 0; i < n; i++) {
-                // Only nodes that are masked
-                if (mask[i]) {
-                    g_logger(name)->trace("Copying node {} resulting in {}.", i, new_graph->nodes.size());
-                    // Check if this is a mapped node
-                    auto it = provided.find(nodes[i]);
-                    if(it != provided.end()){
-                        mapping[nodes[i]] = it->second;
-                        continue;
-                    }
-                    // Check if it is an input node
-                    if(nodes[i]->op->name == "Input" and not allow_input_copies){
-                        auto const msg = fmt::format("The input {} "
-                                                             "did not had a provided mapped value during "
-                                                             "copying and allow_input_copies=false.",
-                                                     to_string(nodes[i]));
-                        g_logger(name)->error(msg);
-                        throw InternalGraphError("CopyInto", msg);
-                    } else if(nodes[i]->op->name == "SharedInput" and not allow_parameter_copies){
-                        auto const msg = fmt::format("The parameter {} "
-                                                             "did not had a provided mapped value during "
-                                                             "copying and allow_parameter_copies=false.",
-                                                     to_string(nodes[i]));
-                        g_logger(name)->error(msg);
-                        throw InternalGraphError("CopyInto", msg);
-                    }
-                    // Get all of the ancestors of the node and find their corresponding nodes
-                    // in the new graph
-                    NodeVec ancestors = nodes[i]->op->get_ancestors();
-                    NodeVec new_ancestors;
-                    for (size_t j = 0; j < ancestors.size(); j++) {
-                        if(mapping[ancestors[j]].ptr.expired()){
-                            g_logger(name)->error("Attempted to copy node {} with ancestor {}, but the parent "
-                                                          "was not part of the mask.",
-                                                  i, ancestors[j]->id);
-                            throw InternalGraphError("Copy", "Attempted to copy node " + std::to_string(i)
-                                                             + " with ancestor " + std::to_string(ancestors[j]->id)
-                                                             + ", but the parent was not part of the mask.");
-                        }
-                        new_ancestors.push_back(mapping[ancestors[j]]);
+            size_t const first_new = new_graph->nodes.size();
+            new_graph->nodes.reserve(first_new + mask.count());
+            // The scopes of this graph translated to the new graph, each is imported only once
+            ScopeId const invalid_scope = std::numeric_limits<ScopeId>::max();
+            std::vector<ScopeId> new_scopes(scopes.size(), invalid_scope);
+            ScopeId const old_scope = new_graph->scope;
+            // Reused for the ancestors of every copied node
+            NodeVec new_ancestors;
+            // Copy nodes, only those that are masked
+            for (auto i: mask) {
+                // Check if this is a mapped node
+                if(remap.contains(i)){
+                    continue;
+                }
+                NodeData const * const data = nodes.data(i);
+                g_logger(name)->trace("Copying node {} resulting in {}.", i, new_graph->nodes.size());
+                // Check if it is an input node
+                if(data->op->kind == OpKind::Input and not allow_input_copies){
+                    auto const msg = fmt::format("The input {} "
+                                                         "did not had a provided mapped value during "
+                                                         "copying and allow_input_copies=false.",
+                                                 to_string(nodes[i]));
+                    g_logger(name)->error(msg);
+                    throw InternalGraphError("CopyInto", msg);
+                } else if(data->op->kind == OpKind::Parameter and not allow_parameter_copies){
+                    auto const msg = fmt::format("The parameter {} "
+                                                         "did not had a provided mapped value during "
+                                                         "copying and allow_parameter_copies=false.",
+                                                 to_string(nodes[i]));
+                    g_logger(name)->error(msg);
+                    throw InternalGraphError("CopyInto", msg);
+                }
+                // Get all of the ancestors of the node and find their corresponding nodes
+                // in the new graph
+                auto ancestors = edges.ancestors(i);
+                new_ancestors.clear();
+                for (size_t j = 0; j < ancestors.size(); j++) {
+                    if(not remap.contains(ancestors[j])){
+                        g_logger(name)->error("Attempted to copy node {} with ancestor {}, but the parent "
+                                                      "was not part of the mask.",
+                                              i, ancestors[j]);
+                        throw InternalGraphError("Copy", "Attempted to copy node " + std::to_string(i)
+                                                         + " with ancestor " + std::to_string(ancestors[j])
+                                                         + ", but the parent was not part of the mask.");
                     }
-                    // Copy the node using the new ancestors and put it in the mapping
-                    Operator op = nodes[i]->op->copy_to(new_graph.get(), new_ancestors);
-                    mapping[nodes[i]] = new_graph->derived_node(op, nodes[i]->name);
-                    mapping[nodes[i]]->scope = nodes[i]->scope;
-                    mapping[nodes[i]]->grad_level = nodes[i]->grad_level;
+                    new_ancestors.push_back(remap.node(ancestors[j]));
+                }
+                // Copy the node using the new ancestors and put it in the mapping, in the same scope
+                if(new_scopes[data->scope] == invalid_scope){
+                    new_scopes[data->scope] = new_graph->scopes.import(scopes, data->scope,
+                                                                       new_graph->props.scope_delimiter);
+                }
+                new_graph->scope = new_scopes[data->scope];
+                Operator op = data->op->copy_to(new_graph.get(), new_ancestors);
+                // A duplicate, such as a recomputed node, must not be merged with the node it is equal to
+                Node const result = data->duplicate ? new_graph->duplicate_node(op, data->name) :
+                                    new_graph->derived_node(op, data->name);
+                // A node of the new graph, with which the copy was merged, keeps its own grad level
+                if(result.id >= first_new){
+                    result->grad_level = data->grad_level;
                 }
+                remap.set(i, result.id);
             }
+            new_graph->scope = old_scope;
             if(copy_updates) {
                 // Copy the updates, by just adding the corresponding nodes
                 for (auto it = updates.begin(); it != updates.end(); ++it) {
-                    auto r1 = mapping.find(it->first);
-                    auto r2 = mapping.find(it->second);
-                    if(r1 == mapping.end() or r2 == mapping.end()) {
+                    if(not remap.contains(it->first.id) or not remap.contains(it->second.id)) {
                         g_logger(name)->error("Could not copy the update for node {} "
                                                       " because it was not part of the mask.", it->first->id);
                         throw InternalGraphError("Copy", "Could not copy the update for node "
                                                          + std::to_string(it->first->id)
                                                          + " because it was not part of the mask.");
                     } else {
-                        api::update(mapping[r1->second], mapping[r2->second]);
+                        api::update(remap.node(it->first.id), remap.node(it->second.id));
                     }
                 }
             }
             g_logger(name)->trace("Copy completed");
-            return mapping;
+            return remap;
         }
 
-        Graph GraphInternal::clone(std::vector<bool> const & mask, bool copy_updates) const{
+        IdRemap GraphInternal::copy_masks_into(Graph new_graph, std::vector<NodeSet> const & masks,
+                                               Updates const & provided,
+                                               bool allow_input_copies, bool allow_parameter_copies,
+                                               bool copy_updates) const {
+            // Since the nodes are copied in order of their ids, the union is copied in a single pass
+            NodeSet all(nodes.size());
+            for(auto i = 0; i < masks.size(); ++i){
+                NodeSet overlap = all;
+                overlap &= masks[i];
+                if(not overlap.none()){
+                    g_logger(name)->error("The mask {} overlaps with the previous masks at node {}.",
+                                          i, *overlap.begin());
+                    throw InternalGraphError("CopyMasksInto", "The mask " + std::to_string(i)
+                                                              + " overlaps with the previous masks at node "
+                                                              + std::to_string(*overlap.begin()) + ".");
+                }
+                all |= masks[i];
+            }
+            return remap_into(new_graph, all, provided, allow_input_copies, allow_parameter_copies, copy_updates);
+        }
+
+        Graph GraphInternal::clone(NodeSet const & mask, bool copy_updates) const{
             auto new_graph = create_graph();
             new_graph->name = name + "_clone";
             new_graph->props = props;
-            copy_into(new_graph, mask, Updates{} ,true, true, copy_updates);
-            new_graph->scope = scope;
+            remap_into(new_graph, mask, Updates{}, true, true, copy_updates);
+            new_graph->scope = new_graph->scopes.import(scopes, scope, props.scope_delimiter);
             new_graph->grad_level = grad_level;
             return new_graph;
         }
 
         Graph GraphInternal::clone(bool copy_updates) const{
-            std::vector<bool> mask(nodes.size(), true);
+            NodeSet mask(nodes.size(), true);
             return clone(mask, copy_updates);
         }
 
-        Updates GraphInternal::apply(Graph new_graph, std::vector<bool> const & mask,
+        Updates GraphInternal::apply(Graph new_graph, NodeSet const & mask,
                                      Updates const & provided,
                                      bool copy_updates, bool allow_shared_copies) const{
             return copy_into(new_graph, mask, provided ,false, allow_shared_copies, copy_updates);
         }
 
-        std::vector<bool> GraphInternal::get_descendants_mask(NodeVec const & roots) const {
+        NodeVec GraphInternal::compact(NodeVec const & outputs, Updates const & updates_to_keep) {
+            NodeVec leafs = outputs;
+            for(auto it = updates_to_keep.begin(); it != updates_to_keep.end(); ++it){
+                leafs.push_back(it->first);
+                leafs.push_back(it->second);
+            }
+            for(auto i = 0; i < leafs.size(); ++i){
+                if(leafs[i].g().get() != this){
+                    g_logger(name)->error("Node {} requested for compacting is not part of this graph.", leafs[i].id);
+                    throw InternalGraphError("Compact", "Node " + std::to_string(leafs[i].id) +
+                                                        " requested for compacting is not part of this graph.");
+                }
+            }
+            auto const n = nodes.size();
+            NodeSet const mask = get_ancestors_mask(leafs);
+            // The kept nodes are renumbered densely, so the new id is never larger than the old one
+            NodeVec mapping(n, Node());
+            size_t count = 0;
+            for(auto i: mask){
+                mapping[i] = Node(this, count++);
+            }
+            // Move each node to its new slot, after all of its ancestors have been moved to theirs,
+            // and recreate the operator with the ancestors at their new ids
+            for(auto i: mask){
+                NodeVec ancestors;
+                for(auto ancestor: edges.ancestors(i)){
+                    ancestors.push_back(mapping[ancestor]);
+                }
+                Operator op = nodes[i]->op->copy_to(this, ancestors);
+                size_t const id = mapping[i].id;
+                nodes.relocate(i, id);
+                NodeData * const data = nodes.data(id);
+                data->op = op;
+                op->result = mapping[i];
+            }
+            nodes.truncate(count);
+            // Rebuild the edges and the maps in the order of the nodes
+            edges.clear();
+            structure_map.clear();
+            group_map.clear();
+            op_map.clear();
+            for(size_t i = 0; i < count; ++i){
+                Node node = nodes[i];
+                Operator const op = node->op;
+                edges.append(op->ancestors_view());
+                structure_map[op->hash()].push_back(node);
+                group_map[node->scope].push_back(node);
+                if(op->kind != OpKind::Alias){
+                    op_map[op->kind].push_back(node);
+                }
+            }
+            Updates kept;
+            for(auto it = updates.begin(); it != updates.end(); ++it){
+                Node const & first = mapping[it->first.id];
+                Node const & second = mapping[it->second.id];
+                if(first.empty() or second.empty()){
+                    g_logger(name)->debug("Dropping the update of node {} during compacting.", it->first.id);
+                } else {
+                    kept[first] = second;
+                }
+            }
+            updates = kept;
+            // The ids of the snapshots and of the cached derivatives are no longer valid
+            snapshots.clear();
+            journal.clear();
+            derivative_cache.clear();
+            g_logger(name)->debug("Compacted the graph from {} to {} nodes.", n, count);
+            return mapping;
+        }
+
+        Snapshot GraphInternal::snapshot() {
+            snapshots.push_back({++last_version, nodes.size()});
+            return Snapshot{this, last_version, nodes.size(), journal.size(), updates, scope, grad_level};
+        }
+
+        void GraphInternal::rollback(Snapshot const & snapshot) {
+            auto it = std::find_if(snapshots.begin(), snapshots.end(), [&](std::pair<size_t, size_t> const & s){
+                return s.first == snapshot.version;
+            });
+            if(snapshot.graph != this or it == snapshots.end()){
+                g_logger(name)->error("Rolling back to snapshot {} which is not a live snapshot of this graph.",
+                                      snapshot.version);
+                throw InternalGraphError("Rollback", "Rolling back to snapshot " + std::to_string(snapshot.version)
+                                                     + " which is not a live snapshot of this graph.");
+            }
+            // The nodes are registered in the order of creation, hence removing them in reverse
+            // finds each at the back of its lists
+            auto remove = [](NodeVec & list, size_t const id){
+                if(not list.empty() and list.back().id == id){
+                    list.pop_back();
+                } else {
+                    list.erase(std::remove_if(list.begin(), list.end(), [=](Node const & n){return n.id == id;}),
+                               list.end());
+                }
+            };
+            for(auto i = nodes.size(); i-- > snapshot.num_nodes;){
+                NodeData const * const data = nodes.data(i);
+                remove(structure_map[data->op->hash()], i);
+                remove(group_map[data->scope], i);
+                if(data->op->kind != OpKind::Alias){
+                    remove(op_map[data->op->kind], i);
+                }
+            }
+            edges.truncate(snapshot.num_nodes);
+            nodes.truncate(snapshot.num_nodes);
+            // Undo the in place changes, the oldest record of each node is restored last
+            for(auto i = journal.size(); i-- > snapshot.journal_size;){
+                if(journal[i].id < snapshot.num_nodes){
+                    NodeData * const data = nodes.data(journal[i].id);
+                    data->name = std::move(journal[i].name);
+                    data->grad_level = journal[i].grad_level;
+                }
+            }
+            journal.resize(snapshot.journal_size);
+            // Drop the cached derivatives which refer to removed nodes
+            for(auto entry = derivative_cache.begin(); entry != derivative_cache.end();){
+                bool removed = std::any_of(entry->first.begin() + 1, entry->first.end(), [&](size_t const id){
+                    return id >= snapshot.num_nodes;
+                }) or std::any_of(entry->second.begin(), entry->second.end(), [&](Node const & node){
+                    return node.id >= snapshot.num_nodes;
+                });
+                entry = removed ? derivative_cache.erase(entry) : std::next(entry);
+            }
+            snapshots.erase(it + 1, snapshots.end());
+            updates = snapshot.updates;
+            scope = snapshot.scope;
+            grad_level = snapshot.grad_level;
+            g_logger(name)->debug("Rolled back to snapshot {} with {} nodes.", snapshot.version, snapshot.num_nodes);
+        }
+
+        void GraphInternal::release(Snapshot const & snapshot) {
+            auto it = std::find_if(snapshots.begin(), snapshots.end(), [&](std::pair<size_t, size_t> const & s){
+                return s.first == snapshot.version;
+            });
+            if(snapshot.graph == this){
+                snapshots.erase(it, snapshots.end());
+            }
+            if(snapshots.empty()){
+                journal.clear();
+            }
+        }
+
+        void GraphInternal::touch(Node const node) {
+            if(not snapshots.empty() and node.id < snapshots.back().second){
+                NodeData const * const data = nodes.data(node.id);
+                journal.push_back(NodeRecord{node.id, data->name, data->grad_level});
+            }
+        }
+
+        NodeSet GraphInternal::get_descendants_mask(NodeVec const & roots) const {
             g_logger(name)->trace("Generating descendants mask");
             auto n = nodes.size();
-            std::vector<bool> descendants_mask(n, false);
+            NodeSet descendants_mask(n);
 
             // Mark all of the roots
             for (int i = 0; i < roots.size(); i++) {
-                descendants_mask[roots[i]->id] = true;
+                descendants_mask.insert(roots[i]->id);
             }
 
-            // For each node that is already marked mark all of its children
-            for (auto i = 0; i < n; ++i) {
-                if (descendants_mask[i]) {
-                    auto children = nodes[i]->children;
-                    for (auto j = 0; j < children.size(); ++j) {
-                        descendants_mask[children[j]->id] = true;
-                    }
+            // For each node that is already marked mark all of its children,
+            // which always have larger ids and are visited later
+            for (auto i: descendants_mask) {
+                for (auto child: edges.children(i)) {
+                    descendants_mask.insert(child);
                 }
             }
             return descendants_mask;
         };
 
-        std::vector<bool> GraphInternal::get_ancestors_mask(NodeVec const & leafs) const {
+        NodeSet GraphInternal::get_ancestors_mask(NodeVec const & leafs) const {
             g_logger(name)->trace("Generating ancestors mask");
             auto n = nodes.size();
-            std::vector<bool> ancestors_mask(n, false);
+            NodeSet ancestors_mask(n);
 
             // Mark all of the leafs
             for (int i = 0; i < leafs.size(); i++) {
-                ancestors_mask[leafs[i]->id] = true;
+                ancestors_mask.insert(leafs[i]->id);
             }
 
-            // For each node that is already marked mark all of its ancestors
-            for (size_t i = n - 1; i < n; i--) {
-                if (ancestors_mask[i]) {
-                    auto ancestors = nodes[i]->op->get_ancestors();
-                    for (auto j = 0; j < ancestors.size(); ++j) {
-                        ancestors_mask[ancestors[j]->id] = true;
-                    }
+            // For each node that is already marked mark all of its ancestors,
+            // which always have smaller ids and are visited later
+            for (auto i = ancestors_mask.previous(n); i < n; i = ancestors_mask.previous(i)) {
+                for (auto ancestor: edges.ancestors(i)) {
+                    ancestors_mask.insert(ancestor);
                 }
             }
             return ancestors_mask;
         };
 
 
-        std::vector<bool> GraphInternal::get_flow_tree_mask(NodeVec const & roots, NodeVec const & leafs) const {
-            auto descendants_mask = get_descendants_mask(roots);
-            auto ancestors_mask = get_ancestors_mask(leafs);
-            for(auto i=0; i < descendants_mask.size(); ++i){
-                descendants_mask[i] = descendants_mask[i] and ancestors_mask[i];
+        NodeSet GraphInternal::get_flow_tree_mask(NodeVec const & roots, NodeVec const & leafs) const {
+            NodeSet flow_tree(nodes.size());
+            for(auto i: get_flow_tree(roots, leafs)){
+                flow_tree.insert(i);
             }
-            return descendants_mask;
+            return flow_tree;
+        }
+
+        FlowTree GraphInternal::get_flow_tree(NodeVec const & roots, NodeVec const & leafs) const {
+            g_logger(name)->trace("Generating flow tree");
+            FlowTree flow_tree;
+            // Nodes outside [first, last] can not be both a descendant of a root and an ancestor of a leaf
+            size_t first = nodes.size(), last = 0;
+            for(auto i = 0; i < roots.size(); ++i){
+                first = first > roots[i]->id ? roots[i]->id : first;
+            }
+            for(auto i = 0; i < leafs.size(); ++i){
+                last = last < leafs[i]->id ? leafs[i]->id : last;
+            }
+            if(roots.empty() or leafs.empty() or first > last){
+                return flow_tree;
+            }
+            // Backward sweep, collecting the ancestors of the leafs in decreasing order, offset by first
+            size_t const span = last - first + 1;
+            NodeSet marked(span);
+            for(auto i = 0; i < leafs.size(); ++i){
+                if(leafs[i]->id >= first){
+                    marked.insert(leafs[i]->id - first);
+                }
+            }
+            std::vector<size_t> ancestors;
+            for(auto i = marked.previous(span); i < span; i = marked.previous(i)){
+                ancestors.push_back(i + first);
+                for(auto ancestor: edges.ancestors(i + first)){
+                    if(ancestor >= first){
+                        marked.insert(ancestor - first);
+                    }
+                }
+            }
+            // Forward sweep over those only, keeping the descendants of the roots
+            NodeSet descendants(span);
+            for(auto i = 0; i < roots.size(); ++i){
+                if(roots[i]->id <= last){
+                    descendants.insert(roots[i]->id - first);
+                }
+            }
+            for(auto it = ancestors.rbegin(); it != ancestors.rend(); ++it){
+                bool descendant = descendants[*it - first];
+                for(auto ancestor: edges.ancestors(*it)){
+                    if(descendant){
+                        break;
+                    }
+                    descendant = ancestor >= first and descendants[ancestor - first];
+                }
+                if(descendant){
+                    descendants.insert(*it - first);
+                    flow_tree.push_back(*it);
+                }
+            }
+            return flow_tree;
         }
 
+        std::vector<NodeSet> GraphInternal::get_flow_tree_masks(std::vector<NodeVec> const & roots,
+                                                                std::vector<NodeVec> const & leafs) const {
+            if(roots.size() != leafs.size()){
+                g_logger(name)->error("Different number of roots ({}) and leafs ({}) provided for the flow trees.",
+                                      roots.size(), leafs.size());
+                throw InternalGraphError("FlowTree", "Different number of roots and leafs provided for the flow trees.");
+            }
+            g_logger(name)->trace("Generating {} flow tree masks", roots.size());
+            auto n = nodes.size();
+            auto k = roots.size();
+            std::vector<NodeSet> flow_trees(k, NodeSet(n));
+            // Nodes outside [first, last] can not be both a descendant of a root and an ancestor of a leaf
+            size_t first = n, last = 0;
+            for(auto q = 0; q < k; ++q){
+                for(auto i = 0; i < roots[q].size(); ++i){
+                    first = first > roots[q][i]->id ? roots[q][i]->id : first;
+                }
+                for(auto i = 0; i < leafs[q].size(); ++i){
+                    last = last < leafs[q][i]->id ? leafs[q][i]->id : last;
+                }
+            }
+            if(first > last){
+                return flow_trees;
+            }
+            // Each node has a row of words, whose bit q marks the node for query q
+            typedef NodeSet::Word Word;
+            size_t const w = (k + NodeSet::word_bits - 1) / NodeSet::word_bits;
+            size_t const span = last - first + 1;
+            std::vector<Word> descendants(span * w, 0);
+            std::vector<Word> ancestors(span * w, 0);
+            for(auto q = 0; q < k; ++q){
+                Word const bit = Word(1) << (q % NodeSet::word_bits);
+                for(auto i = 0; i < roots[q].size(); ++i){
+                    if(roots[q][i]->id <= last){
+                        descendants[(roots[q][i]->id - first) * w + q / NodeSet::word_bits] |= bit;
+                    }
+                }
+                for(auto i = 0; i < leafs[q].size(); ++i){
+                    if(leafs[q][i]->id >= first){
+                        ancestors[(leafs[q][i]->id - first) * w + q / NodeSet::word_bits] |= bit;
+                    }
+                }
+            }
+            // Forward sweep, each node pulls the queries of its ancestors
+            for(auto i = first; i <= last; ++i){
+                Word * const row = descendants.data() + (i - first) * w;
+                for(auto ancestor: edges.ancestors(i)){
+                    if(ancestor >= first){
+                        Word const * const other = descendants.data() + (ancestor - first) * w;
+                        for(auto j = 0; j < w; ++j){
+                            row[j] |= other[j];
+                        }
+                    }
+                }
+            }
+            // Backward sweep, each node pushes its queries to its ancestors
+            for(auto i = last; i >= first and i <= last; --i){
+                Word const * const row = ancestors.data() + (i - first) * w;
+                for(auto ancestor: edges.ancestors(i)){
+                    if(ancestor >= first){
+                        Word * const other = ancestors.data() + (ancestor - first) * w;
+                        for(auto j = 0; j < w; ++j){
+                            other[j] |= row[j];
+                        }
+                    }
+                }
+            }
+            // Transpose the intersection of the two into the sets of each query
+            for(auto i = first; i <= last; ++i){
+                for(auto j = 0; j < w; ++j){
+                    Word word = descendants[(i - first) * w + j] & ancestors[(i - first) * w + j];
+                    while(word != 0){
+                        flow_trees[j * NodeSet::word_bits + __builtin_ctzll(word)].insert(i);
+                        word &= word - 1;
+                    }
+                }
+            }
+            return flow_trees;
+        }
 
         Node GraphInternal::find_same_node(Operator op) {
-            // TODO This needs more rigorous approach together with symbolically_equals() and AbstractOperator::equals()
-            if (op->get_parents().size() > 0) {
-                NodeVec candidates = op->get_parents()[0]->children;
+            return find_same_node(op, op->hash());
+        };
+
+        Node GraphInternal::find_same_node(Operator op, size_t hash) {
+            auto it = structure_map.find(hash);
+            if (it != structure_map.end()) {
+                NodeVec const & candidates = it->second;
                 for (int i = 0; i < candidates.size(); i++) {
-                    Operator candidate_op = candidates[i]->op;
-                    if (candidate_op->equals(op) or op->equals(candidate_op)) {
+                    if (op->equals(candidates[i]->op)) {
                         g_logger(name)->debug("Found node with id {} equal to operator {}",candidates[i]->id, op->name);
                         return candidates[i];
                     }
@@ -289,7 +695,199 @@ namespace md{
             return Node();
         };
 
-        NodeVec GraphInternal::backward_diff(NodeVec const & f, NodeVec const & u_in, NodeVec const & w){
+        namespace {
+            /** Recomputes the node from the nearest nodes which are kept, copying each of the recomputed
+             * ancestors it needs only once and before the copies of their children.
+             * The copies are not merged with the originals, since they are evaluated separately.
+             */
+            Node recompute(GraphInternal * const graph, size_t const id, NodeSet const & recomputed, IdRemap & copies){
+                std::vector<size_t> stack{id};
+                NodeVec new_ancestors;
+                ScopeId const old_scope = graph->scope;
+                while(not stack.empty()){
+                    size_t const top = stack.back();
+                    if(copies.contains(top)){
+                        stack.pop_back();
+                        continue;
+                    }
+                    bool ready = true;
+                    for(auto ancestor: graph->edges.ancestors(top)){
+                        if(recomputed[ancestor] and not copies.contains(ancestor)){
+                            stack.push_back(ancestor);
+                            ready = false;
+                        }
+                    }
+                    if(ready){
+                        stack.pop_back();
+                        new_ancestors.clear();
+                        for(auto ancestor: graph->edges.ancestors(top)){
+                            new_ancestors.push_back(recomputed[ancestor] ? copies.node(ancestor) : graph->nodes[ancestor]);
+                        }
+                        NodeData const * const data = graph->nodes.data(top);
+                        unsigned int const grad_level = data->grad_level;
+                        graph->scope = data->scope;
+                        Node const copy = graph->duplicate_node(data->op->copy_to(graph, new_ancestors), data->name);
+                        graph->touch(copy);
+                        copy->grad_level = grad_level;
+                        copies.set(top, copy.id);
+                    }
+                }
+                graph->scope = old_scope;
+                return copies.node(id);
+            }
+
+            /** Verifies that all of the nodes are part of the graph, before their ids are used in it */
+            void verify_graph(Graph const graph, NodeVec const & nodes, std::string const op_name,
+                              std::string const var){
+                for(auto i=0; i<nodes.size(); ++i){
+                    if(graph != nodes[i].g()){
+                        op_logger(op_name)->error("{}[{}] is not part of this graph.", var, i);
+                        throw InvalidOperatorArgument(nodes, op_name,
+                                                      var + "[" + std::to_string(i) + "] is not part of this graph.");
+                    }
+                }
+            }
+
+            /** Returns whether there are fewer elements than other for all large enough values of the symbolic
+             * dimensions, which are positive - that is when the terms of the highest degree of their difference
+             * are all positive. Constant counts are simply compared. */
+            bool fewer_elements(SymInt const & elements, SymInt const & other){
+                SymInt const difference = other - elements;
+                int highest = -1;
+                bool positive = false;
+                for(auto m = 0; m < difference.monomials.size(); ++m){
+                    int degree = 0;
+                    for(auto p = 0; p < difference.monomials[m].powers.size(); ++p){
+                        degree += difference.monomials[m].powers[p].second;
+                    }
+                    if(degree > highest){
+                        highest = degree;
+                        positive = difference.monomials[m].coefficient > 0;
+                    } else if(degree == highest){
+                        positive = positive and difference.monomials[m].coefficient > 0;
+                    }
+                }
+                return positive;
+            }
+
+            /** Returns the placeholders, or copies, of the nodes in the builder */
+            NodeVec import_all(GraphBuilder & builder, NodeVec const & nodes){
+                NodeVec imported;
+                for(auto i = 0; i < nodes.size(); ++i){
+                    imported.push_back(builder.import(nodes[i]));
+                }
+                return imported;
+            }
+
+            /** Returns the key of a backward_diff() in GraphInternal::derivative_cache - the grad level of the result,
+             * followed by the number and the ids of each of f, u, w and the checkpoints */
+            std::vector<size_t> derivative_key(NodeVec const & f, NodeVec const & u, NodeVec const & w,
+                                               NodeSet const * checkpoints){
+                unsigned int level = 0;
+                for(auto i = 0; i < f.size(); ++i){
+                    level = std::max(level, f[i]->grad_level + 1);
+                }
+                std::vector<size_t> key = {level};
+                for(auto const nodes: {&f, &u, &w}){
+                    key.push_back(nodes->size());
+                    for(auto i = 0; i < nodes->size(); ++i){
+                        key.push_back((*nodes)[i].id);
+                    }
+                }
+                if(checkpoints != nullptr){
+                    key.push_back(checkpoints->count());
+                    for(auto i: *checkpoints){
+                        key.push_back(i);
+                    }
+                }
+                return key;
+            }
+
+            /** Returns the shape with the number of directions along the batch axis */
+            Shape directions_shape(Shape shape, int const axis, SymInt const directions){
+                shape[axis] = directions;
+                return shape;
+            }
+
+            /** Applies the derivative, built in the builder for the placeholder of the directions, to all of the unit
+             * directions at once, batched along the batch axis of the derivative, such that the k-th of them is the
+             * k-th column of the identity. The results have the number of directions as their last dimension and
+             * only they and their ancestors are merged into the target, leaving out the placeholder. */
+            NodeVec apply_unit_directions(GraphBuilder & builder, Node const placeholder, NodeVec const & derivatives){
+                Graph const graph = builder.graph;
+                // The other inputs the derivatives depend on are provided as they are,
+                // so only the descendants of the placeholder are batched
+                NodeSet const ancestors = graph->get_ancestors_mask(derivatives);
+                NodeVec inputs;
+                for(auto const & input: graph->op_map[OpKind::Input]){
+                    if(ancestors[input.id] or input.id == placeholder.id){
+                        inputs.push_back(input);
+                    }
+                }
+                GraphFunction function("Jacobian", graph, inputs, derivatives, Updates(), false);
+                int const axis = function.batch_axis();
+                if(axis < 0){
+                    op_logger("Jacobian")->error("The derivatives use all axes, hence there is no axis for the directions.");
+                    throw InvalidOperatorArgument(derivatives, "Jacobian",
+                                                  "The derivatives use all axes, hence there is no axis for the directions.");
+                }
+                SymInt const directions = number_of_elements(placeholder->shape);
+                NodeVec provided = inputs;
+                for(auto i = 0; i < inputs.size(); ++i){
+                    if(inputs[i].id == placeholder.id){
+                        Node const identity = graph->eye(directions, placeholder->data_type);
+                        provided[i] = api::reshape(identity, directions_shape(placeholder->shape, axis, directions));
+                    }
+                }
+                NodeVec results = function.apply_batched(graph, provided);
+                for(auto i = 0; i < results.size(); ++i){
+                    results[i] = api::reshape(results[i], {number_of_elements(derivatives[i]->shape), directions, 1, 1});
+                }
+                Updates merged = builder.merge_into(results);
+                for(auto i = 0; i < results.size(); ++i){
+                    results[i] = merged[results[i]];
+                }
+                return results;
+            }
+        }
+
+        NodeSet GraphInternal::select_checkpoints(NodeVec const & f, NodeVec const & w,
+                                                  size_t max_checkpoints) const {
+            // Only the nodes which would otherwise be recomputed are candidates
+            std::vector<size_t> candidates;
+            for(auto i: get_flow_tree_mask(w, f)){
+                if(edges.ancestors(i).size() > 0){
+                    candidates.push_back(i);
+                }
+            }
+            if(max_checkpoints == 0){
+                max_checkpoints = static_cast<size_t>(std::ceil(std::sqrt(candidates.size())));
+            }
+            NodeSet checkpoints(nodes.size());
+            if(max_checkpoints >= candidates.size()){
+                for(auto i: candidates){
+                    checkpoints.insert(i);
+                }
+            } else if(max_checkpoints > 0){
+                // The last node of each of the max_checkpoints segments of equal length
+                for(size_t k = 1; k <= max_checkpoints; ++k){
+                    checkpoints.insert(candidates[k * candidates.size() / max_checkpoints - 1]);
+                }
+            }
+            return checkpoints;
+        }
+
+        NodeVec GraphInternal::backward_diff(NodeVec const & f, NodeVec const & u, NodeVec const & w){
+            return backward_diff(f, u, w, nullptr, nullptr);
+        }
+
+        NodeVec GraphInternal::backward_diff(NodeVec const & f, NodeVec const & u, NodeVec const & w,
+                                             NodeSet const & checkpoints){
+            return backward_diff(f, u, w, &checkpoints, nullptr);
+        }
+
+        NodeVec GraphInternal::backward_diff(NodeVec const & f, NodeVec const & u_in, NodeVec const & w,
+                                             NodeSet const * checkpoints, FlowTree const * shared_tree){
             // If no parameters return empty vector as well
             if(w.size() == 0){
                 return NodeVec();
@@ -327,6 +925,13 @@ namespace md{
                                                   "w[" + std::to_string(i) + "] is not part of this graph.");
                 }
             }
+            // The same derivative is built only once
+            std::vector<size_t> const key = derivative_key(f, u_in, w, checkpoints);
+            auto const cached = derivative_cache.find(key);
+            if(cached != derivative_cache.end()){
+                op_logger("BackwardDiff")->trace("Reusing the cached BackwardDiff");
+                return cached->second;
+            }
             // Verify all of the u's are correct shapes
             NodeVec u = u_in;
             for(auto i=0; i<f.size(); ++i){
@@ -335,29 +940,73 @@ namespace md{
 
             op_logger("BackwardDiff")->trace("Starting BackwardDiff");
 
-            std::vector<bool> flow_tree = get_flow_tree_mask(w, f);
+            // Recomputed nodes are added to the flow tree, so a shared one is copied
+            FlowTree flow_tree = shared_tree != nullptr ? *shared_tree : get_flow_tree(w, f);
 
-            // Contains all of the backward messages
-            std::vector<NodeVec> messages(nodes.size(), NodeVec{});
+            // Contains all of the backward messages, indexed by the position of the node in the flow tree
+            std::vector<NodeVec> messages(flow_tree.size(), NodeVec{});
+            diff_start = nodes.size();
 
             // The first messages are u_i -> f_i
-            size_t max_id = 0;
-            size_t min_id = nodes.size();
             for(auto i=0; i<f.size(); ++i){
                 op_logger("BackwardDiff")->trace("Initial message u[{}] -> f[{}] is {} -> {}", i, i, u[i]->id, f[i]->id);
-                messages[f[i]->id].push_back(u[i]);
-                max_id = max_id < f[i]->id ? f[i]->id : max_id;
-                min_id = min_id > f[i]->id ? f[i]->id : min_id;
+                auto const position = flow_tree.position(f[i]->id);
+                if(position != FlowTree::missing){
+                    messages[position].push_back(u[i]);
+                }
                 grad_level = grad_level < (f[i]->grad_level + (unsigned int)(1)) ? (f[i]->grad_level + (unsigned int)(1)) : grad_level;
             }
-            for(auto i=0; i<w.size(); ++i){
-                min_id = min_id > w[i]->id ? w[i]->id : min_id;
+
+            // The forward nodes which are recomputed, rather than kept, and their copies
+            NodeSet recomputed;
+            IdRemap copies;
+            NodeSet targets;
+            if(checkpoints != nullptr){
+                recomputed = NodeSet(nodes.size());
+                copies = IdRemap(this, nodes.size());
+                targets = NodeSet(nodes.size());
+                for(auto i = 0; i < w.size(); ++i){
+                    targets.insert(w[i]->id);
+                }
+                for(auto i: flow_tree){
+                    if(not (*checkpoints)[i] and not targets[i] and edges.ancestors(i).size() > 0){
+                        recomputed.insert(i);
+                    }
+                }
             }
 
-            // Generate all the messages around
-            for (auto i = max_id; i >= min_id; --i) {
-                if (flow_tree[i]) {
+            // Generate all the messages around, visiting only the nodes of the flow tree in reverse order
+            for (auto p = flow_tree.size(); p-- > 0;) {
+                auto const i = flow_tree[p];
+                // A kept node with recomputed ancestors is recomputed as well, since its derivatives depend on them
+                bool recompute_node = recomputed[i];
+                if(checkpoints != nullptr and not targets[i]){
+                    for(auto ancestor: edges.ancestors(i)){
+                        recompute_node = recompute_node or recomputed[ancestor];
+                    }
+                }
+                if(not recompute_node){
                     nodes[i]->op->backward_diff(messages, flow_tree);
+                } else if(not messages[p].empty()){
+                    // The copies take the place of the originals in the flow tree, they are the newest nodes
+                    auto const old_size = nodes.size();
+                    Node const copy = recompute(this, i, recomputed, copies);
+                    for(auto id = old_size; id < nodes.size(); ++id){
+                        flow_tree.push_back(id);
+                    }
+                    messages.resize(flow_tree.size());
+                    messages[flow_tree.position(copy.id)] = std::move(messages[p]);
+                    messages[p].clear();
+                    copy->op->backward_diff(messages, flow_tree);
+                    NodeView const parents = nodes[i]->op->parents_view();
+                    for(auto j = 0; j < parents.size(); ++j){
+                        if(recomputed[parents[j]->id]){
+                            auto & copy_messages = messages[flow_tree.position(copies[parents[j]->id])];
+                            auto & parent_messages = messages[flow_tree.position(parents[j]->id)];
+                            parent_messages.insert(parent_messages.end(), copy_messages.begin(), copy_messages.end());
+                            copy_messages.clear();
+                        }
+                    }
                 }
             }
 
@@ -366,7 +1015,9 @@ namespace md{
 
             NodeVec outputs;
             for (auto i = 0; i < w.size(); ++i) {
-                if(messages[w[i]->id].size() == 0){
+                auto const position = flow_tree.position(w[i]->id);
+                NodeVec const & w_messages = position != FlowTree::missing ? messages[position] : NodeVec{};
+                if(w_messages.size() == 0){
                     switch (props.policies.independent_derivative){
                         case RAISE: {
                             op_logger("BackwardDiff")->error("None of the functions (f) depend on the parameter w[{}].", i);
@@ -379,19 +1030,25 @@ namespace md{
                         default: ;
                     }
                     outputs.push_back(constant(0));
-                } else if(messages[w[i]->id].size() == 1){
-                    outputs.push_back(messages[w[i]->id][0]);
+                } else if(w_messages.size() == 1){
+                    outputs.push_back(w_messages[0]);
                 } else {
                     op_logger("BackwardDiff")->error("w[{}] has more than one backward message left.", i);
                     throw InternalGraphError("BackwardDiff", "w[" + std::to_string(i) +
                                                              "] has more than one backward message left.");
                 }
             }
+            derivative_cache[key] = outputs;
             op_logger("BackwardDiff")->trace("Finished BackwardDiff");
             return outputs;
         }
 
-        NodeVec GraphInternal::forward_diff(NodeVec const & f, NodeVec const & v_in, NodeVec const & w){
+        NodeVec GraphInternal::forward_diff(NodeVec const & f, NodeVec const & v, NodeVec const & w){
+            return forward_diff(f, v, w, nullptr);
+        }
+
+        NodeVec GraphInternal::forward_diff(NodeVec const & f, NodeVec const & v_in, NodeVec const & w,
+                                            FlowTree const * shared_tree){
             // If no parameters return empty vector as well
             if(w.size() == 0){
                 return NodeVec();
@@ -438,29 +1095,29 @@ namespace md{
             }
             op_logger("ForwardDiff")->trace("Starting ForwardDiff");
 
-            std::vector<bool> flow_tree = get_flow_tree_mask(w, f);
-            // Contains all of the backward messages
-            NodeVec derivatives(nodes.size(), Node());
+            FlowTree const own_tree = shared_tree != nullptr ? FlowTree() : get_flow_tree(w, f);
+            FlowTree const & flow_tree = shared_tree != nullptr ? *shared_tree : own_tree;
+            // Contains all of the derivatives, indexed by the position of the node in the flow tree
+            NodeVec derivatives(flow_tree.size(), Node());
+            diff_start = nodes.size();
 
-            size_t max_id = 0;
-            size_t min_id = nodes.size();
-            for(auto i=0; i<f.size(); ++i){
-                max_id = max_id < f[i]->id ? f[i]->id : max_id;
-            }
             // The directional derivatives at w[i] are just v[i]
+            NodeSet targets(flow_tree.size());
             for(auto i=0; i<w.size(); ++i){
                 op_logger("ForwardDiff")->trace("Initial derivatives for w[{}] = {}", w[i]->id, v[i]->id);
-                derivatives[w[i]->id] = v[i];
-                min_id = min_id > f[i]->id ? f[i]->id : min_id;
+                auto const position = flow_tree.position(w[i]->id);
+                if(position != FlowTree::missing){
+                    derivatives[position] = v[i];
+                    // w[i] is not visited
+                    targets.insert(position);
+                }
                 grad_level = grad_level < (w[i]->grad_level + (unsigned int)(1)) ? (w[i]->grad_level + (unsigned int)(1)) : grad_level;
-                // Remove w[i] from the flow_tree
-                flow_tree[w[i]->id] = false;
             }
 
-            // Generate all the directional derivatives
-            for (auto i = min_id; i <= max_id; ++i) {
-                if (flow_tree[i]) {
-                    nodes[i]->op->forward_diff(derivatives);
+            // Generate all the directional derivatives, visiting only the nodes of the flow tree in order
+            for (auto p = 0; p < flow_tree.size(); ++p) {
+                if(not targets[p]){
+                    nodes[flow_tree[p]]->op->forward_diff(derivatives, flow_tree);
                 }
             }
 
@@ -469,7 +1126,8 @@ namespace md{
 
             NodeVec outputs;
             for (auto i = 0; i < f.size(); ++i) {
-                if(derivatives[f[i]->id].ptr.expired()){
+                auto const position = flow_tree.position(f[i]->id);
+                if(position == FlowTree::missing or derivatives[position].empty()){
                     switch (props.policies.independent_derivative){
                         case RAISE: {
                             op_logger("ForwardDiff")->error("The function f[{}] does not depend on any of the parameters (w)", i);
@@ -483,7 +1141,7 @@ namespace md{
                     }
                     outputs.push_back(constant(0));
                 } else {
-                    outputs.push_back(derivatives[f[i]->id]);
+                    outputs.push_back(derivatives[position]);
                 }
             }
 
@@ -492,65 +1150,232 @@ namespace md{
             return outputs;
         }
 
+        std::vector<NodeVec> GraphInternal::jvp(NodeVec const & f, NodeVec const & w,
+                                                std::vector<NodeVec> const & directions){
+            verify_graph(shared_from_this(), f, "JVP", "f");
+            verify_graph(shared_from_this(), w, "JVP", "w");
+            // The flow tree does not depend on the direction
+            FlowTree const flow_tree = get_flow_tree(w, f);
+            std::vector<NodeVec> products;
+            for(auto k = 0; k < directions.size(); ++k){
+                products.push_back(forward_diff(f, directions[k], w, &flow_tree));
+            }
+            return products;
+        }
 
-        Node GraphInternal::derived_node(Operator op, std::string name) {
-            Node same_node = find_same_node(op);
-            if (same_node.ptr.expired()) {
-                auto result = std::make_shared<NodeData>(
-                        shared_from_this(),
-                        nodes.size(),
-                        name,
-                        props.default_device,
-                        op,
-                        grad_level > op->get_grad_level() ? grad_level : op->get_grad_level(),
-                        scope
-                );
-                nodes.push_back(result);
-                op->result = result;
-                NodeVec ancestors = op->get_ancestors();
-                for (int i = 0; i < ancestors.size(); i++) {
-                    ancestors[i]->children.push_back(result);
-                }
-                // Add the node to the group map
-                if(group_map.find(scope) == group_map.end()){
-                    group_map[scope] = NodeVec{result};
+        std::vector<NodeVec> GraphInternal::vjp(NodeVec const & f, NodeVec const & w,
+                                                std::vector<NodeVec> const & directions){
+            verify_graph(shared_from_this(), f, "VJP", "f");
+            verify_graph(shared_from_this(), w, "VJP", "w");
+            // The flow tree does not depend on the direction
+            FlowTree const flow_tree = get_flow_tree(w, f);
+            std::vector<NodeVec> products;
+            for(auto k = 0; k < directions.size(); ++k){
+                products.push_back(backward_diff(f, directions[k], w, nullptr, &flow_tree));
+            }
+            return products;
+        }
+
+        std::vector<NodeVec> GraphInternal::hvp(Node const f, NodeVec const & w,
+                                                std::vector<NodeVec> const & directions){
+            verify_graph(shared_from_this(), NodeVec{f}, "HVP", "f");
+            if(w.size() == 0 or directions.size() == 0){
+                return std::vector<NodeVec>(directions.size());
+            }
+            // Forward-over-reverse, every product is the directional derivative of the same gradient
+            NodeVec const grads = api::gradient(f, w);
+            return jvp(grads, w, directions);
+        }
+
+        std::vector<NodeVec> GraphInternal::backward_diff_concurrently(std::vector<NodeVec> const & f,
+                                                                       std::vector<NodeVec> const & u,
+                                                                       NodeVec const & w, size_t const threads){
+            if(f.size() != u.size()){
+                op_logger("BackwardDiffConcurrently")->error("Different number of functions (f) and evaluation points (u) provided.");
+                throw InvalidOperatorArgument(w, "BackwardDiffConcurrently",
+                                              "Different number of functions (f) and evaluation points (u) provided.");
+            }
+            Graph const g = shared_from_this();
+            for(auto k = 0; k < f.size(); ++k){
+                verify_graph(g, f[k], "BackwardDiffConcurrently", "f[" + std::to_string(k) + "]");
+                verify_graph(g, u[k], "BackwardDiffConcurrently", "u[" + std::to_string(k) + "]");
+            }
+            verify_graph(g, w, "BackwardDiffConcurrently", "w");
+            if(f.empty()){
+                return std::vector<NodeVec>();
+            }
+            // The forward structure is only read while building, each task copies just its own flow tree
+            auto const masks = get_flow_tree_masks(std::vector<NodeVec>(f.size(), w), f);
+            return build_concurrently(g, f.size(), [&](GraphBuilder & builder, size_t k) {
+                builder.import_copies(masks[k]);
+                return builder.graph->backward_diff(import_all(builder, f[k]), import_all(builder, u[k]),
+                                                    import_all(builder, w));
+            }, threads);
+        }
+
+        std::vector<NodeVec> GraphInternal::forward_diff_concurrently(NodeVec const & f,
+                                                                      std::vector<NodeVec> const & v,
+                                                                      NodeVec const & w, size_t const threads){
+            Graph const g = shared_from_this();
+            verify_graph(g, f, "ForwardDiffConcurrently", "f");
+            verify_graph(g, w, "ForwardDiffConcurrently", "w");
+            for(auto k = 0; k < v.size(); ++k){
+                verify_graph(g, v[k], "ForwardDiffConcurrently", "v[" + std::to_string(k) + "]");
+            }
+            if(v.empty()){
+                return std::vector<NodeVec>();
+            }
+            // All of the directions share the same flow tree
+            NodeSet const mask = get_flow_tree_mask(w, f);
+            return build_concurrently(g, v.size(), [&](GraphBuilder & builder, size_t k) {
+                builder.import_copies(mask);
+                return builder.graph->forward_diff(import_all(builder, f), import_all(builder, v[k]),
+                                                   import_all(builder, w));
+            }, threads);
+        }
+
+        DiffMode GraphInternal::jacobian_mode(Node const f, NodeVec const & w) const {
+            SymInt parameter_elements = 0;
+            for(auto i = 0; i < w.size(); ++i){
+                parameter_elements = parameter_elements + number_of_elements(w[i]->shape);
+            }
+            return fewer_elements(parameter_elements, number_of_elements(f->shape)) ? FORWARD_MODE : REVERSE_MODE;
+        }
+
+        NodeVec GraphInternal::jacobian(Node const f, NodeVec const & w, DiffMode mode){
+            verify_graph(shared_from_this(), NodeVec{f}, "Jacobian", "f");
+            verify_graph(shared_from_this(), w, "Jacobian", "w");
+            if(mode == AUTOMATIC_MODE){
+                mode = jacobian_mode(f, w);
+            }
+            op_logger("Jacobian")->trace("Starting Jacobian in {} mode", to_string(mode));
+            SymInt const f_elements = number_of_elements(f->shape);
+            FlowTree const flow_tree = get_flow_tree(w, NodeVec{f});
+            // The Jacobians with respect to the parameters which f does not depend on are zero
+            NodeVec jacobians(w.size());
+            NodeVec dependent;
+            for(auto i = 0; i < w.size(); ++i){
+                if(flow_tree.contains(w[i]->id)){
+                    dependent.push_back(w[i]);
                 } else {
-                    group_map[scope].push_back(result);
+                    jacobians[i] = zeros({f_elements, number_of_elements(w[i]->shape), 1, 1}, f->data_type);
                 }
-                // Add the node to the op map
-                if(op->name != "Alias"){
-                    if(op_map.find(op->name) == op_map.end()){
-                        op_map[op->name] = NodeVec{result};
+            }
+            if(dependent.empty()){
+                return jacobians;
+            }
+            // The placeholders of the directions and the derivatives built for them are not part of the result,
+            // hence they are built in a builder over the flow tree and only the result is merged
+            NodeSet flow_tree_mask(nodes.size());
+            for(auto i: flow_tree){
+                flow_tree_mask.insert(i);
+            }
+            NodeVec results;
+            if(mode == FORWARD_MODE){
+                // Every parameter has its own tangents, all of which are propagated together
+                for(auto i = 0; i < dependent.size(); ++i){
+                    Node const & w_i = dependent[i];
+                    SymInt const w_elements = number_of_elements(w_i->shape);
+                    if(w_elements == 1){
+                        Node const v = constant(1, w_i->data_type, w_i->shape);
+                        Node const tangent = forward_diff(NodeVec{f}, NodeVec{v}, NodeVec{w_i}, &flow_tree)[0];
+                        results.push_back(api::reshape(tangent, {f_elements, 1, 1, 1}));
                     } else {
-                        group_map[op->name].push_back(result);
+                        GraphBuilder builder(shared_from_this(), name + "_jacobian");
+                        builder.import_copies(flow_tree_mask);
+                        Node const v = builder.graph->tensor4(w_i->data_type, w_i->shape, "Jacobian tangent");
+                        Node const tangent = builder.graph->forward_diff(NodeVec{builder.import(f)}, NodeVec{v},
+                                                                         NodeVec{builder.import(w_i)})[0];
+                        results.push_back(apply_unit_directions(builder, v, NodeVec{tangent})[0]);
                     }
                 }
-                return result;
+            } else if(f_elements == 1){
+                // A single cotangent is just the gradient
+                Node const u = constant(1, f->data_type, f->shape);
+                NodeVec const grads = backward_diff(NodeVec{f}, NodeVec{u}, dependent, nullptr, &flow_tree);
+                for(auto i = 0; i < grads.size(); ++i){
+                    results.push_back(api::reshape(grads[i], {1, number_of_elements(grads[i]->shape), 1, 1}));
+                }
             } else {
-                return alias(same_node);
+                // All of the cotangents are propagated together, resulting in the transposed Jacobians
+                GraphBuilder builder(shared_from_this(), name + "_jacobian");
+                builder.import_copies(flow_tree_mask);
+                Node const u = builder.graph->tensor4(f->data_type, f->shape, "Jacobian cotangent");
+                NodeVec const grads = builder.graph->backward_diff(NodeVec{builder.import(f)}, NodeVec{u},
+                                                                   import_all(builder, dependent));
+                for(auto const & transposed: apply_unit_directions(builder, u, grads)){
+                    results.push_back(api::transpose(transposed));
+                }
+            }
+            for(auto i = 0, j = 0; i < w.size(); ++i){
+                if(jacobians[i].empty()){
+                    jacobians[i] = results[j++];
+                }
             }
+            op_logger("Jacobian")->trace("Finished Jacobian");
+            return jacobians;
+        }
+
+
+        Node GraphInternal::derived_node(Operator op, std::string name) {
+            size_t const hash = op->hash();
+            Node same_node = find_same_node(op, hash);
+            if (same_node.empty()) {
+                return insert_node(op, name, hash);
+            } else {
+                return same_node;
+            }
+        }
+
+        Node GraphInternal::duplicate_node(Operator op, std::string name) {
+            Node const result = insert_node(op, name, op->hash());
+            result->duplicate = true;
+            return result;
+        }
+
+        Node GraphInternal::insert_node(Operator op, std::string const & name, size_t const hash) {
+            unsigned int const op_grad_level = op->get_grad_level();
+            Node result = nodes.emplace(
+                    name,
+                    props.default_device,
+                    op,
+                    grad_level > op_grad_level ? grad_level : op_grad_level,
+                    scope
+            );
+            op->result = result;
+            edges.append(op->ancestors_view());
+            structure_map[hash].push_back(result);
+            // Add the node to the group map
+            if(group_map.find(scope) == group_map.end()){
+                group_map[scope] = NodeVec{result};
+            } else {
+                group_map[scope].push_back(result);
+            }
+            // Add the node to the op map
+            if(op->kind != OpKind::Alias){
+                if(op_map.find(op->kind) == op_map.end()){
+                    op_map[op->kind] = NodeVec{result};
+                } else {
+                    op_map[op->kind].push_back(result);
+                }
+            }
+            return result;
         }
 
         void GraphInternal::set_scope(std::string full_name){
-            scope = full_name;
+            scope = scopes.intern(full_name, props.scope_delimiter);
         };
 
         void GraphInternal::push_scope(std::string name){
-            scope += props.scope_delimiter;
-            scope += name;
+            scope = scopes.child(scope, name, props.scope_delimiter);
         }
 
         void GraphInternal::pop_scope() {
-            auto last_delimiter = scope.find_last_of(props.scope_delimiter);
-            if(last_delimiter == std::string::npos){
-                scope = "";
-            } else {
-                scope = scope.substr(0, last_delimiter);
-            }
+            scope = scopes.parent(scope);
         }
 
         void GraphInternal::reset_scope(){
-            scope = "";
+            scope = ScopeTable::root;
         }
 
         std::string GraphInternal::get_parent_group_name(std::string full_name){
@@ -6,18 +6,18 @@
 namespace md{
     namespace gir{
 
-        NodeData::NodeData(std::weak_ptr<GraphInternal> const graph,
+        NodeData::NodeData(GraphInPtr const graph,
                            size_t id,
                            std::string name,
                            Device device,
                            Operator op,
                            unsigned int grad_level,
-                           std::string scope):
+                           ScopeId scope):
                 graph(graph),
                 id(id),
                 name(name),
                 data_type(op->get_data_type()),
-                shape(op->get_shape()),
+                shape(op->get_interned_shape()),
                 op(op),
                 is_input_dependent(op->is_input_dependent()),
                 is_differentiable(op->is_differentiable()),
@@ -26,12 +26,11 @@ namespace md{
                 scope(scope) { }
 
         Graph  Node::g() const {
-            auto ptr = unwrap();
-            if (ptr->graph.expired()) {
-                logger("XXX::node::XXX")->error("Trying to access the graph of a Node, but the pointer has expired");
-                ptr->graph.lock();
+            if (empty()) {
+                logger("XXX::node::XXX")->error("Trying to access the graph of an empty Node");
+                return Graph();
             }
-            return ptr->graph.lock();
+            return graph->shared_from_this();
         }
 
 //        void Node::copy_to(const Graph graph, NodeVec ancestors) const {
@@ -56,21 +55,57 @@ namespace md{
 //            }
 //        }
 
-        std::shared_ptr<NodeData> Node::unwrap() const{
-            if (ptr.expired()) {
-                logger("XXX::node::XXX")->error("Trying to access the NodeData of a Node, but pointer has expired");
-                ptr.lock();
-            }
-            return ptr.lock();
-        }
-
         int Node::order() const {
+            auto const & shape = unwrap()->shape;
+            auto const one = graph->sym_table.one();
             for(auto i=0; i<4; ++i){
-                if(unwrap()->shape[3-i] != 1){
+                if(shape.id(3-i) != one){
                     return 4-i;
                 }
             }
             return 0;
         }
+
+        NodeArena::~NodeArena() {
+            for(size_t i = 0; i < count; ++i){
+                data(i)->~NodeData();
+            }
+            for(size_t i = 0; i < blocks.size(); ++i){
+                ::operator delete(blocks[i]);
+            }
+        }
+
+        Node NodeArena::emplace(std::string name, Device device, Operator op,
+                                unsigned int grad_level, ScopeId scope) {
+            reserve(count + 1);
+            new (data(count)) NodeData(graph, count, std::move(name), device,
+                                       std::move(op), grad_level, scope);
+            return Node(graph, count++);
+        }
+
+        void NodeArena::reserve(size_t const n) {
+            while(blocks.size() * block_size < n){
+                blocks.push_back(static_cast<NodeData*>(::operator new(sizeof(NodeData) * block_size)));
+            }
+        }
+
+        void NodeArena::relocate(size_t const from, size_t const to) {
+            if(from == to){
+                return;
+            }
+            NodeData * const target = data(to);
+            target->~NodeData();
+            new (target) NodeData(std::move(*data(from)));
+            target->id = to;
+        }
+
+        void NodeArena::truncate(size_t const n) {
+            for(size_t i = n; i < count; ++i){
+                data(i)->~NodeData();
+            }
+            if(n < count){
+                count = n;
+            }
+        }
     }
 }
\ No newline at end of file
@@ -0,0 +1,62 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#include "graph_ir.h"
+
+namespace md{
+    namespace gir{
+        namespace {
+#define GIR_OPERATOR_KIND_NAME(NAME) #NAME,
+            /** The names of the builtin kinds, indexed by their value */
+            std::string const builtin_names[] = {"", GIR_OPERATOR_KINDS(GIR_OPERATOR_KIND_NAME)};
+#undef GIR_OPERATOR_KIND_NAME
+
+            size_t const num_builtin = static_cast<size_t>(OpKind::Custom);
+
+            /** The registry of the kinds, the custom names are in a deque which never moves its elements */
+            struct OpKindRegistry {
+                std::mutex mutex;
+                std::unordered_map<std::string, OpKind> kinds;
+                std::deque<std::string> custom_names;
+
+                OpKindRegistry() {
+                    for (size_t i = 1; i < num_builtin; ++i) {
+                        kinds[builtin_names[i]] = static_cast<OpKind>(i);
+                    }
+                }
+            };
+
+            OpKindRegistry & registry() {
+                static OpKindRegistry instance;
+                return instance;
+            }
+        }
+
+        OpKind op_kind(std::string const & name) {
+            auto & r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            auto it = r.kinds.find(name);
+            if (it != r.kinds.end()) {
+                return it->second;
+            }
+            if (num_builtin + r.custom_names.size() > std::numeric_limits<uint16_t>::max()) {
+                throw InternalGraphError("OpKind", "Too many operator kinds registered.");
+            }
+            auto const kind = static_cast<OpKind>(num_builtin + r.custom_names.size());
+            r.custom_names.push_back(name);
+            r.kinds[name] = kind;
+            return kind;
+        }
+
+        std::string const & op_kind_name(OpKind const kind) {
+            auto const index = static_cast<size_t>(kind);
+            if (index < num_builtin) {
+                return builtin_names[index];
+            }
+            auto & r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            return r.custom_names.at(index - num_builtin);
+        }
+    }
+}
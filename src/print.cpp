@@ -65,6 +65,15 @@ namespace md{
             }
         }
 
+        std::string to_string(DiffMode const mode) {
+            switch (mode){
+                case AUTOMATIC_MODE: return "Automatic";
+                case FORWARD_MODE: return "Forward";
+                default: return "Reverse";
+//                case REVERSE_MODE: return "Reverse";
+            }
+        }
+
         std::string to_string(Device const device){
             return fmt::format("{}[{}]", to_string(device.type), device.id);
         }
@@ -80,7 +89,7 @@ namespace md{
             std::string s = fmt::format("Node[{},{}]{} = {}(", node->id,
                                         to_string(node->data_type),
                                         to_string(node->shape), node->op->name);
-            auto ancestors = node->op->get_ancestors();
+            auto const ancestors = node->op->ancestors_view();
             if(ancestors.size() > 0) {
                 s += std::to_string(ancestors[0]->id);
             }
@@ -0,0 +1,60 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#include "graph_ir.h"
+
+namespace md{
+    namespace gir{
+        ScopeId const ScopeTable::root;
+
+        ScopeTable::ScopeTable() {
+            scopes.push_back(Scope{root, "", ""});
+            ids[""] = root;
+        }
+
+        ScopeId ScopeTable::child(ScopeId const parent, std::string const & name, std::string const & delimiter) {
+            if (name.empty()) {
+                return parent;
+            }
+            std::string full_name = parent == root ? name : scopes[parent].full_name + delimiter + name;
+            auto it = ids.find(full_name);
+            if (it != ids.end()) {
+                return it->second;
+            }
+            auto const id = static_cast<ScopeId>(scopes.size());
+            ids[full_name] = id;
+            scopes.push_back(Scope{parent, name, std::move(full_name)});
+            return id;
+        }
+
+        ScopeId ScopeTable::intern(std::string const & full_name, std::string const & delimiter) {
+            auto it = ids.find(full_name);
+            if (it != ids.end()) {
+                return it->second;
+            }
+            ScopeId id = root;
+            size_t start = 0;
+            while (start <= full_name.size()) {
+                auto end = delimiter.empty() ? std::string::npos : full_name.find(delimiter, start);
+                if (end == std::string::npos) {
+                    end = full_name.size();
+                }
+                id = child(id, full_name.substr(start, end - start), delimiter);
+                start = end + std::max<size_t>(delimiter.size(), 1);
+            }
+            return id;
+        }
+
+        ScopeId ScopeTable::import(ScopeTable const & table, ScopeId const id, std::string const & delimiter) {
+            if (id == root) {
+                return root;
+            }
+            auto it = ids.find(table.full_name(id));
+            if (it != ids.end()) {
+                return it->second;
+            }
+            return child(import(table, table.parent(id), delimiter), table.name(id), delimiter);
+        }
+    }
+}
@@ -0,0 +1,97 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#include "graph_ir.h"
+
+namespace md{
+    namespace gir{
+        namespace {
+            /** The id of the next body */
+            std::atomic<size_t> next_id(0);
+            /** Guards the derivatives of all bodies. It is recursive, since differentiating a body which calls
+             * another one computes the derivatives of the inner body on the same thread */
+            std::recursive_mutex derivatives_mutex;
+        }
+
+        SubRoutineBody::SubRoutineBody(std::string const name,
+                                       Graph const graph,
+                                       NodeVec const inputs,
+                                       NodeVec const outputs):
+                name(name),
+                id(next_id++),
+                function(name, graph, inputs, outputs, Updates(), false) {
+            if(outputs.empty()){
+                g_logger(graph->name)->error("The subroutine {} has no outputs.", name);
+                throw InvalidOperatorArgument(inputs, "SubRoutine", "The subroutine " + name + " has no outputs.");
+            }
+            if(not function.op_nodes(OpKind::Parameter).empty()){
+                g_logger(graph->name)->error("The subroutine {} contains parameters, "
+                                                     "which should be passed as inputs instead.", name);
+                throw InvalidOperatorArgument(outputs, "SubRoutine", "The subroutine " + name + " contains parameters, "
+                        "which should be passed as inputs instead.");
+            }
+        }
+
+        SubRoutineBody::Derivative const & SubRoutineBody::backward(size_t const output) {
+            std::lock_guard<std::recursive_mutex> lock(derivatives_mutex);
+            auto it = backward_derivatives.find(output);
+            if(it != backward_derivatives.end()){
+                return it->second;
+            }
+            Graph const graph = function.graph;
+            Node const f = function.outputs[output];
+            // Only the differentiable inputs which the output depends on have a derivative
+            auto const ancestors = graph->get_ancestors_mask(NodeVec{f});
+            Derivative derivative;
+            derivative.index.assign(function.inputs.size(), -1);
+            NodeVec w;
+            for(auto i = 0; i < function.inputs.size(); ++i){
+                if(ancestors[function.inputs[i].id] and function.inputs[i]->is_differentiable){
+                    derivative.index[i] = static_cast<int>(w.size());
+                    w.push_back(function.inputs[i]);
+                }
+            }
+            if(not w.empty()){
+                Node const u = graph->tensor4(f->data_type, f->shape, "Grad of " + name);
+                NodeVec const grads = graph->backward_diff(NodeVec{f}, NodeVec{u}, w);
+                NodeVec inputs = function.inputs;
+                inputs.push_back(u);
+                derivative.body = make_subroutine(name + "_backward_" + std::to_string(output), graph, inputs, grads);
+            }
+            return backward_derivatives[output] = derivative;
+        }
+
+        SubRoutineBody::Derivative const & SubRoutineBody::forward(size_t const output, size_t const input) {
+            std::lock_guard<std::recursive_mutex> lock(derivatives_mutex);
+            size_t const key = output * function.inputs.size() + input;
+            auto it = forward_derivatives.find(key);
+            if(it != forward_derivatives.end()){
+                return it->second;
+            }
+            Graph const graph = function.graph;
+            Node const f = function.outputs[output];
+            Node const w = function.inputs[input];
+            auto const ancestors = graph->get_ancestors_mask(NodeVec{f});
+            Derivative derivative;
+            derivative.index.assign(function.inputs.size(), -1);
+            if(ancestors[w.id] and w->is_differentiable){
+                Node const v = graph->tensor4(w->data_type, w->shape, "Tangent of " + name);
+                NodeVec const tangents = graph->forward_diff(NodeVec{f}, NodeVec{v}, NodeVec{w});
+                NodeVec inputs = function.inputs;
+                inputs.push_back(v);
+                derivative.index[input] = 0;
+                derivative.body = make_subroutine(name + "_forward_" + std::to_string(output) +
+                                                  "_" + std::to_string(input), graph, inputs, tangents);
+            }
+            return forward_derivatives[key] = derivative;
+        }
+
+        SubRoutinePtr make_subroutine(std::string const name,
+                                      Graph const graph,
+                                      NodeVec const inputs,
+                                      NodeVec const outputs){
+            return std::make_shared<SubRoutineBody>(name, graph, inputs, outputs);
+        }
+    }
+}
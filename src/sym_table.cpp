@@ -0,0 +1,46 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#include "graph_ir.h"
+
+namespace md{
+    namespace gir{
+        SymIntTable::SymIntTable() {
+            unit = intern(SymInt(1));
+        }
+
+        size_t SymIntTable::hash(SymInt const & value) {
+            size_t seed = value.monomials.size();
+            for (auto m = 0; m < value.monomials.size(); ++m) {
+                auto const & monomial = value.monomials[m];
+                seed ^= std::hash<int64_t>()(monomial.coefficient) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+                for (auto p = 0; p < monomial.powers.size(); ++p) {
+                    auto const & power = monomial.powers[p];
+                    size_t h = std::hash<std::string>()(power.first.id) ^ (size_t(power.first.type) << 8) ^ power.second;
+                    seed ^= h + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+                }
+            }
+            return seed;
+        }
+
+        SymInt const * SymIntTable::intern(SymInt const & value) {
+            size_t const h = hash(value);
+            auto range = index.equal_range(h);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (*it->second == value) {
+                    return it->second;
+                }
+            }
+            values.push_back(value);
+            SymInt const * id = &values.back();
+            index.insert(std::make_pair(h, id));
+            return id;
+        }
+
+        SymShape SymIntTable::intern(Shape const & shape) {
+            return SymShape(std::array<SymInt const *, 4>{{intern(shape[0]), intern(shape[1]),
+                                                           intern(shape[2]), intern(shape[3])}});
+        }
+    }
+}
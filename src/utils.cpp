@@ -18,6 +18,9 @@ namespace md{
         }
 
         Logger logger(std::string const name, LogLevel const level){
+            // Graphs can be built on several threads (see build_concurrently()), which must not register the same logger twice
+            static std::mutex registry_mutex;
+            std::lock_guard<std::mutex> lock(registry_mutex);
             Logger ptr = spdlog::get(name);
             if (not ptr) {
                 ptr = std::make_shared<spdlog::logger>(name, gir_sink());
@@ -59,8 +62,8 @@ namespace md{
 
         Operator get_base_op(Operator const op) {
             Operator base_op = op;
-            while (base_op->name == "Alias") {
-                base_op = base_op->get_parents()[0]->op;
+            while (base_op->kind == OpKind::Alias) {
+                base_op = base_op->parents_view()[0]->op;
             }
             return base_op;
         }
@@ -69,6 +72,17 @@ namespace md{
             return get_base_op(node->op)->result;
         }
 
+        bool is_constant_value(Node const node, double const value){
+            Operator base_op = get_base_op(node->op);
+            while (base_op->kind == OpKind::Broadcast) {
+                base_op = get_base_op(base_op->parents_view()[0]->op);
+            }
+            if(base_op->kind != OpKind::ConstantValue){
+                return false;
+            }
+            return std::dynamic_pointer_cast<op::ConstantValue>(base_op)->value == value;
+        }
+
         bool symbolic_equals(Node const & node1, Node const & node2) {
             if (node1->id == node2->id) {
                 return true;
@@ -85,14 +99,20 @@ namespace md{
         };
 
 
-        Shape get_max_shape(NodeVec const & nodes, std::string const op_name){
-            Shape shape = {1, 1, 1, 1};
+        SymShape get_max_shape(NodeVec const & nodes, std::string const op_name){
+            if(nodes.size() == 0){
+                return SymShape();
+            }
+            auto const & table = nodes[0].g()->sym_table;
+            auto const one = table.one();
+            SymShape shape = table.scalar();
             for(auto i=0; i < nodes.size(); ++i){
+                auto const & node_shape = nodes[i]->shape;
                 for(auto j=0; j < 4; ++j){
-                    if(shape[j] != nodes[i]->shape[j]){
-                        if(shape[j] == 1){
-                            shape[j] = nodes[i]->shape[j];
-                        } else if (nodes[i]->shape[j] != 1){
+                    if(shape.id(j) != node_shape.id(j)){
+                        if(shape.id(j) == one){
+                            shape.set(j, node_shape.id(j));
+                        } else if (node_shape.id(j) != one){
                             throw throw_op_iae(nodes, op_name, "Incompatible shapes in nodes: \n" + to_string(nodes));
                         }
                     }
@@ -102,6 +122,10 @@ namespace md{
         }
 
         Node implicit_broadcast(Node const node, Shape const shape, std::string const op_name) {
+            return implicit_broadcast(node, node.g()->sym_table.intern(shape), op_name);
+        }
+
+        Node implicit_broadcast(Node const node, SymShape const shape, std::string const op_name) {
             if(node->shape != shape and node.order() > 0){
                 Graph g = node.g();
                 switch (g->props.policies.implicit_broadcast){
@@ -183,9 +207,13 @@ namespace md{
         }
 
         std::vector<std::string> unique_dimensions(Graph graph) {
+            return unique_dimensions(graph, NodeSet(graph->nodes.size(), true));
+        }
+
+        std::vector<std::string> unique_dimensions(Graph graph, NodeSet const & mask) {
             std::set<std::string> unique;
-            for(auto i=0; i < graph->nodes.size(); ++i){
-                if(graph->nodes[i]->op->name == "SymIntWrapper"){
+            for(auto i: mask){
+                if(graph->nodes[i]->op->kind == OpKind::SymIntWrapper){
                     auto cast_op = std::dynamic_pointer_cast<op::SymIntWrapper>(graph->nodes[i]->op);
                     for (auto m = 0; m < cast_op->value.monomials.size(); ++m) {
                         for (auto p = 0; p < cast_op->value.monomials[m].powers.size(); ++p) {
@@ -249,10 +277,9 @@ namespace md{
                         }
                     }
                 }
-                if (implicit.size() > 0) {
-                    last_verified = sym::deduce_values(implicit);
-                    return true;
-                }
+                // Inputs with only constant shapes have nothing to deduce, but have still changed
+                last_verified = implicit.size() > 0 ? sym::deduce_values(implicit) : last_verified;
+                return true;
             }
             return false;
         }